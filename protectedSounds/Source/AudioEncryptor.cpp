@@ -19,61 +19,523 @@
 #include <juce_core/juce_core.h>
 #include <juce_cryptography/juce_cryptography.h>
 #include <iostream>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "ProtectedContainer.h"
+#include "SamplePack.h"
+#include "SoundCatalog.h"
 
-int main(int argc, char* argv[])
+struct EncryptOptions
+{
+    bool legacy = false;
+    juce::String key;
+    int chunkSize = ProtectedContainerFormat::defaultChunkSize;
+};
+
+struct EncryptJob
+{
+    juce::File input;
+    juce::File output;
+    juce::int64 size = 0;
+};
+
+// ============================================================================
+// CIFRADO DE UN ARCHIVO (en streaming: memoria acotada a un par de trozos)
+// ============================================================================
+
+// Formato antiguo: Blowfish ECB, con el final rellenado con ceros hasta múltiplo de 8
+static bool encryptLegacy(juce::InputStream& input, juce::OutputStream& output,
+                          const juce::String& encryptionKey, int chunkSize)
+{
+    juce::BlowFish blowfish(encryptionKey.toUTF8(), encryptionKey.length());
+
+    chunkSize = juce::jmax(8, chunkSize - chunkSize % 8);
+    juce::HeapBlock<char> buffer((size_t) chunkSize);
+
+    for (;;)
+    {
+        const int bytesRead = input.read(buffer.get(), chunkSize);
+        if (bytesRead <= 0)
+            break;
+
+        // Asegurarse de que el tamaño de los datos es un múltiplo de 8 bytes (64 bits)
+        const int paddedSize = ((bytesRead + 7) / 8) * 8;
+        memset(buffer.get() + bytesRead, 0, (size_t) (paddedSize - bytesRead));
+
+        // Encriptar los datos en bloques de 64 bits
+        for (int i = 0; i < paddedSize; i += 8)
+        {
+            juce::uint32 left, right;
+            memcpy(&left, buffer.get() + i, 4);
+            memcpy(&right, buffer.get() + i + 4, 4);
+
+            blowfish.encrypt(left, right);
+
+            memcpy(buffer.get() + i, &left, 4);
+            memcpy(buffer.get() + i + 4, &right, 4);
+        }
+
+        if (! output.write(buffer.get(), (size_t) paddedSize))
+            return false;
+
+        if (bytesRead < chunkSize)
+            break;
+    }
+
+    output.flush();
+    return true;
+}
+
+static bool encryptFile(const EncryptJob& job, const EncryptOptions& options, juce::String& error)
 {
-    if (argc != 3)
+    juce::FileInputStream input(job.input);
+    if (input.failedToOpen())
+    {
+        error = "could not open input file";
+        return false;
+    }
+
+    job.output.getParentDirectory().createDirectory();
+    job.output.deleteFile();
+
+    juce::FileOutputStream output(job.output);
+    if (output.failedToOpen())
     {
-        std::cout << "Usage: encrypt_audio <input_file> <output_file>" << std::endl;
+        error = "could not create output file";
+        return false;
+    }
+
+    const bool ok = options.legacy ? encryptLegacy(input, output, options.key, options.chunkSize)
+                                   : ProtectedContainerWriter::write(input, output, options.key, options.chunkSize);
+    if (! ok)
+        error = "write failed";
+
+    return ok;
+}
+
+// ============================================================================
+// MODO BATCH
+// ============================================================================
+
+// Pool con una cola por hilo: cada hilo vacía la suya por delante y, cuando se queda
+// sin trabajo, roba por detrás de las colas de los demás.
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int numWorkersToUse)
+        : numWorkers(juce::jmax(1, numWorkersToUse)), queues((size_t) numWorkers)
+    {
+    }
+
+    void run(const std::vector<EncryptJob>& jobs, const std::function<void(const EncryptJob&)>& process)
+    {
+        // Repartir por tamaño decreciente, así los archivos grandes empiezan primero
+        std::vector<size_t> order(jobs.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return jobs[a].size > jobs[b].size; });
+
+        for (size_t i = 0; i < order.size(); ++i)
+            queues[i % queues.size()].jobs.push_back(order[i]);
+
+        std::vector<std::thread> workers;
+        for (int worker = 0; worker < numWorkers; ++worker)
+        {
+            workers.emplace_back([this, worker, &jobs, &process]
+            {
+                size_t jobIndex;
+                while (takeJob(worker, jobIndex))
+                    process(jobs[jobIndex]);
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex lock;
+        std::deque<size_t> jobs;
+    };
+
+    bool takeJob(int worker, size_t& jobIndex)
+    {
+        {
+            auto& own = queues[(size_t) worker];
+            std::lock_guard<std::mutex> sl(own.lock);
+            if (! own.jobs.empty())
+            {
+                jobIndex = own.jobs.front();
+                own.jobs.pop_front();
+                return true;
+            }
+        }
+
+        // No se añaden trabajos durante la ejecución: si todas las colas están vacías, se terminó
+        for (int i = 1; i < numWorkers; ++i)
+        {
+            auto& victim = queues[(size_t) ((worker + i) % numWorkers)];
+            std::lock_guard<std::mutex> sl(victim.lock);
+            if (! victim.jobs.empty())
+            {
+                jobIndex = victim.jobs.back();
+                victim.jobs.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const int numWorkers;
+    std::vector<WorkerQueue> queues;
+};
+
+static bool isAudioFile(const juce::File& file)
+{
+    return file.hasFileExtension("wav;aif;aiff;flac;ogg");
+}
+
+// Directorio de entrada: todos los archivos de audio, replicando la estructura en la salida
+static void collectDirectoryJobs(const juce::File& inputDir, const juce::File& outputDir,
+                                 const EncryptOptions& options, std::vector<EncryptJob>& jobs)
+{
+    const auto extension = options.legacy ? ".dat" : ".psc";
+
+    for (const auto& entry : juce::RangedDirectoryIterator(inputDir, true, "*", juce::File::findFiles))
+    {
+        const auto file = entry.getFile();
+        if (! isAudioFile(file))
+            continue;
+
+        const auto relativePath = file.getRelativePathFrom(inputDir);
+        jobs.push_back({ file, outputDir.getChildFile(relativePath).withFileExtension(extension), entry.getFileSize() });
+    }
+}
+
+// Manifest: una línea por archivo, "entrada<TAB>salida"; sin salida se usa la entrada con otra extensión
+static bool collectManifestJobs(const juce::File& manifest, const EncryptOptions& options,
+                                std::vector<EncryptJob>& jobs)
+{
+    if (! manifest.existsAsFile())
+        return false;
+
+    const auto extension = options.legacy ? ".dat" : ".psc";
+    const auto baseDir = manifest.getParentDirectory();
+
+    juce::StringArray lines;
+    manifest.readLines(lines);
+
+    for (auto line : lines)
+    {
+        line = line.trim();
+        if (line.isEmpty() || line.startsWithChar('#'))
+            continue;
+
+        const auto input = baseDir.getChildFile(line.upToFirstOccurrenceOf("\t", false, false).trim());
+        const auto outputPath = line.fromFirstOccurrenceOf("\t", false, false).trim();
+        const auto output = outputPath.isNotEmpty() ? baseDir.getChildFile(outputPath)
+                                                    : input.withFileExtension(extension);
+
+        jobs.push_back({ input, output, input.getSize() });
+    }
+    return true;
+}
+
+static int runBatch(std::vector<EncryptJob> jobs, const EncryptOptions& options, int numThreads)
+{
+    std::mutex outputLock;
+    std::atomic<int> filesDone { 0 }, filesFailed { 0 };
+    std::atomic<juce::int64> bytesDone { 0 };
+
+    const auto startMs = juce::Time::getMillisecondCounterHiRes();
+
+    // Los workers llaman a ProtectedContainerWriter::write a la vez: no puede usar nada
+    // compartido sin lock (juce::Random, por ejemplo), ni para el nonce ni para nada más
+    WorkStealingPool pool(numThreads);
+    pool.run(jobs, [&](const EncryptJob& job)
+    {
+        juce::String error;
+
+        if (encryptFile(job, options, error))
+        {
+            ++filesDone;
+            bytesDone += job.size;
+        }
+        else
+        {
+            ++filesFailed;
+            std::lock_guard<std::mutex> sl(outputLock);
+            std::cout << "FAILED " << job.input.getFullPathName() << ": " << error << std::endl;
+        }
+    });
+
+    const auto seconds = juce::jmax(1.0e-6, (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0);
+    const auto megabytes = (double) bytesDone.load() / (1024.0 * 1024.0);
+
+    std::cout << "Encrypted " << filesDone.load() << " files (" << filesFailed.load() << " failed), "
+              << juce::String(megabytes, 1) << " MB in " << juce::String(seconds, 2) << " s using "
+              << numThreads << " threads" << std::endl;
+    std::cout << "Throughput: " << juce::String(megabytes / seconds, 1) << " MB/s, "
+              << juce::String(filesDone.load() / seconds, 1) << " files/s" << std::endl;
+
+    return filesFailed.load() == 0 ? 0 : 1;
+}
+
+// ============================================================================
+// PAQUETE DE SONIDOS
+// ============================================================================
+
+// Empaqueta todos los archivos del directorio (ya cifrados o no) en un .pspk mapeable
+static int runPack(const juce::File& inputDir, const juce::File& outputFile)
+{
+    juce::Array<juce::File> files;
+
+    for (const auto& entry : juce::RangedDirectoryIterator(inputDir, true, "*", juce::File::findFiles))
+        if (! entry.isHidden())
+            files.add(entry.getFile());
+
+    // Orden estable para que dos empaquetados del mismo directorio den el mismo archivo
+    files.sort();
+
+    juce::StringArray names;
+    for (const auto& file : files)
+    {
+        const auto name = SamplePackFormat::makeResourceName(file);
+        if (names.contains(name))
+        {
+            std::cout << "Duplicate resource name " << name << " (" << file.getFullPathName() << ")" << std::endl;
+            return 1;
+        }
+        names.add(name);
+    }
+
+    outputFile.deleteFile();
+    juce::FileOutputStream output(outputFile);
+
+    if (output.failedToOpen())
+    {
+        std::cout << "Cannot create " << outputFile.getFullPathName() << std::endl;
         return 1;
     }
 
-    juce::File inputFile(argv[1]);
-    juce::File outputFile(argv[2]);
+    juce::String error;
+    if (! SamplePackWriter::write(files, output, error))
+    {
+        std::cout << "Packing failed: " << error << std::endl;
+        return 1;
+    }
 
-    if (!inputFile.existsAsFile())
+    std::cout << "Packed " << files.size() << " resources into " << outputFile.getFullPathName()
+              << " (" << juce::File::descriptionOfSizeInBytes(output.getPosition()) << ")" << std::endl;
+    return 0;
+}
+
+// ============================================================================
+// CATÁLOGO
+// ============================================================================
+
+// Completa el manifest con los metadatos de cada sonido (duración, frecuencia, canales, pico
+// y loop por defecto), decodificando los audios originales una sola vez aquí y no en el plugin
+static int runCatalog(const juce::File& audioDir, const juce::File& catalogFile)
+{
+    SoundCatalog catalog;
+    juce::String error;
+
+    if (! catalogFile.existsAsFile() || ! catalog.loadFromJSON(catalogFile.loadFileAsString(), error))
     {
-        std::cout << "Input file does not exist." << std::endl;
+        std::cout << "Cannot read catalog " << catalogFile.getFullPathName() << ": " << error << std::endl;
         return 1;
     }
 
-    juce::MemoryBlock originalData;
-    inputFile.loadFileAsData(originalData);
+    std::map<juce::String, juce::File> audioFiles;
+    for (const auto& entry : juce::RangedDirectoryIterator(audioDir, true, "*", juce::File::findFiles))
+        if (isAudioFile(entry.getFile()))
+            audioFiles[entry.getFile().getFileNameWithoutExtension()] = entry.getFile();
 
-    juce::String encryptionKey = "clave";
-    juce::MemoryBlock encryptedData;
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
 
-    juce::BlowFish blowfish(encryptionKey.toUTF8(), encryptionKey.length());
+    SoundCatalog updated;
+
+    for (auto info : catalog.getSounds())
+    {
+        const auto file = audioFiles.find(info.cleanResource);
+        std::unique_ptr<juce::AudioFormatReader> reader(file != audioFiles.end() ? formatManager.createReaderFor(file->second)
+                                                                                 : nullptr);
+        if (reader == nullptr)
+        {
+            std::cout << "No readable audio for " << info.name << " (" << info.cleanResource << ")" << std::endl;
+            return 1;
+        }
+
+        info.lengthInSamples = reader->lengthInSamples;
+        info.sampleRate = reader->sampleRate;
+        info.numChannels = (int) reader->numChannels;
+
+        std::vector<juce::Range<float>> levels(reader->numChannels);
+        reader->readMaxLevels(0, reader->lengthInSamples, levels.data(), (int) reader->numChannels);
+
+        info.peak = 0.0f;
+        for (const auto& level : levels)
+            info.peak = juce::jmax(info.peak, std::abs(level.getStart()), std::abs(level.getEnd()));
+
+        // Se respetan los loops puestos a mano; si no hay uno válido, todo el sonido
+        if (info.loopEnd <= info.loopStart || info.loopEnd > info.lengthInSamples)
+        {
+            info.loopStart = 0;
+            info.loopEnd = info.lengthInSamples;
+        }
+
+        updated.add(info);
+    }
+
+    if (! catalogFile.replaceWithText(updated.toJSON()))
+    {
+        std::cout << "Cannot write " << catalogFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Catalog updated: " << updated.getSounds().size() << " sounds" << std::endl;
+    return 0;
+}
 
-    // Asegurarse de que el tamaño de los datos es un múltiplo de 8 bytes (64 bits)
-    size_t paddedSize = ((originalData.getSize() + 7) / 8) * 8;
-    originalData.setSize(paddedSize, true);
+// ============================================================================
+// MAIN
+// ============================================================================
+
+static void printUsage()
+{
+    std::cout << "Usage: encrypt_audio [options] <input_file> <output_file>" << std::endl
+              << "       encrypt_audio [options] --batch <input_dir> <output_dir>" << std::endl
+              << "       encrypt_audio [options] --batch --manifest <manifest_file>" << std::endl
+              << "       encrypt_audio --pack <input_dir> <output.pspk>" << std::endl
+              << "       encrypt_audio --catalog <audio_dir> <catalog.json>" << std::endl
+              << "Options: --legacy  --key <key>  --chunk-size <bytes>  --threads <n>" << std::endl;
+}
 
-    encryptedData.setSize(paddedSize);
+int main(int argc, char* argv[])
+{
+    EncryptOptions options;
+    bool batch = false;
+    bool pack = false;
+    bool catalog = false;
+    int numThreads = juce::SystemStats::getNumCpus();
+    juce::File manifest;
+    juce::StringArray files;
 
-    // Encriptar los datos en bloques de 64 bits
-    for (size_t i = 0; i < paddedSize; i += 8)
+    for (int i = 1; i < argc; ++i)
     {
-        juce::uint32& left = *reinterpret_cast<juce::uint32*>(originalData.begin() + i);
-        juce::uint32& right = *reinterpret_cast<juce::uint32*>(originalData.begin() + i + 4);
-        
-        blowfish.encrypt(left, right);
-        
-        *reinterpret_cast<juce::uint32*>(encryptedData.begin() + i) = left;
-        *reinterpret_cast<juce::uint32*>(encryptedData.begin() + i + 4) = right;
+        const juce::String arg(argv[i]);
+
+        if (arg == "--legacy")
+            options.legacy = true;
+        else if (arg == "--batch")
+            batch = true;
+        else if (arg == "--pack")
+            pack = true;
+        else if (arg == "--catalog")
+            catalog = true;
+        else if (arg == "--key" && i + 1 < argc)
+            options.key = argv[++i];
+        else if (arg == "--chunk-size" && i + 1 < argc)
+            options.chunkSize = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--threads" && i + 1 < argc)
+            numThreads = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--manifest" && i + 1 < argc)
+            manifest = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else
+            files.add(arg);
     }
 
-    if (encryptedData.getSize() > 0)
+    if (catalog)
     {
-        outputFile.create();
-        outputFile.appendData(encryptedData.getData(), encryptedData.getSize());
-        std::cout << "Encryption successful." << std::endl;
-        return 0;
+        if (files.size() != 2 || batch || pack)
+        {
+            printUsage();
+            return 1;
+        }
+
+        return runCatalog(juce::File::getCurrentWorkingDirectory().getChildFile(files[0]),
+                          juce::File::getCurrentWorkingDirectory().getChildFile(files[1]));
     }
-    else
+
+    if (pack)
     {
-        std::cout << "Encryption failed." << std::endl;
+        if (files.size() != 2 || batch)
+        {
+            printUsage();
+            return 1;
+        }
+
+        const auto inputDir = juce::File::getCurrentWorkingDirectory().getChildFile(files[0]);
+        if (! inputDir.isDirectory())
+        {
+            std::cout << "Input directory does not exist." << std::endl;
+            return 1;
+        }
+        return runPack(inputDir, juce::File::getCurrentWorkingDirectory().getChildFile(files[1]));
+    }
+
+    const bool validArgs = batch ? (manifest != juce::File() ? files.isEmpty() : files.size() == 2)
+                                 : files.size() == 2;
+
+    if (! validArgs || options.chunkSize <= 0 || numThreads <= 0)
+    {
+        printUsage();
         return 1;
     }
-    
+
+    // El contenedor usa por defecto la misma clave que ProtectedSoundsManager
+    if (options.key.isEmpty())
+        options.key = options.legacy ? "clave" : "mysecretkey";
+
+    if (batch)
+    {
+        std::vector<EncryptJob> jobs;
+
+        if (manifest != juce::File())
+        {
+            if (! collectManifestJobs(manifest, options, jobs))
+            {
+                std::cout << "Manifest file does not exist." << std::endl;
+                return 1;
+            }
+        }
+        else
+        {
+            const auto inputDir = juce::File::getCurrentWorkingDirectory().getChildFile(files[0]);
+            if (! inputDir.isDirectory())
+            {
+                std::cout << "Input directory does not exist." << std::endl;
+                return 1;
+            }
+            collectDirectoryJobs(inputDir, juce::File::getCurrentWorkingDirectory().getChildFile(files[1]), options, jobs);
+        }
+
+        return runBatch(std::move(jobs), options, numThreads);
+    }
+
+    juce::File inputFile(files[0]);
+    juce::File outputFile(files[1]);
+
+    if (!inputFile.existsAsFile())
+    {
+        std::cout << "Input file does not exist." << std::endl;
+        return 1;
+    }
+
+    juce::String error;
+    if (encryptFile({ inputFile, outputFile, inputFile.getSize() }, options, error))
+    {
+        std::cout << "Encryption successful." << std::endl;
+        return 0;
+    }
+
+    std::cout << "Encryption failed: " << error << std::endl;
+    return 1;
 }
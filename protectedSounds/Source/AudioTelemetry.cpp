@@ -0,0 +1,35 @@
+/*
+  ==============================================================================
+
+    AudioTelemetry.cpp
+    Created: 18 Oct 2026 12:48:16am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "AudioTelemetry.h"
+
+void TelemetryChannel::push(const TelemetryFrame& frame) noexcept
+{
+    if (fifo.getFreeSpace() == 0)
+        return;
+
+    const auto scope = fifo.write(1);
+    frames[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = frame;
+}
+
+bool TelemetryChannel::pullLatest(TelemetryFrame& dest) noexcept
+{
+    const auto numReady = fifo.getNumReady();
+
+    if (numReady == 0)
+        return false;
+
+    // Las fotos intermedias no interesan: sólo se copia la última
+    const auto scope = fifo.read(numReady);
+    const auto lastIndex = scope.blockSize2 > 0 ? scope.startIndex2 + scope.blockSize2 - 1
+                                                : scope.startIndex1 + scope.blockSize1 - 1;
+    dest = frames[(size_t) lastIndex];
+    return true;
+}
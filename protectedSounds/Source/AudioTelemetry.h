@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    AudioTelemetry.h
+    Created: 18 Oct 2026 12:48:16am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Estado de una voz visto desde la interfaz
+struct VoiceTelemetry
+{
+    enum class Stage : juce::uint8 { idle, attack, decay, sustain, release };
+
+    Stage stage = Stage::idle;
+    int layer = 0;          // 0 = selector 1, 1 = selector 2
+    int midiNote = -1;
+    float position = 0.0f;  // fracción de la duración del sonido
+    float level = 0.0f;     // valor actual de la envolvente
+};
+
+// Foto de todas las voces al final de un bloque
+struct TelemetryFrame
+{
+    static constexpr int maxVoices = 64;
+
+    int numVoices = 0;
+    int numActiveVoices = 0;
+    std::array<VoiceTelemetry, maxVoices> voices {};
+};
+
+// Canal SPSC sin esperas del hilo de audio a la interfaz. El audio publica una foto por bloque
+// y si el editor no lee (o está cerrado) las fotos nuevas se descartan: nunca hay locks ni
+// reservas de memoria en el lado del audio.
+class TelemetryChannel
+{
+public:
+    TelemetryChannel() = default;
+
+    // Hilo de audio
+    void push(const TelemetryFrame& frame) noexcept;
+
+    // Hilo de mensajes: se queda con la foto más reciente; false si no había ninguna nueva
+    bool pullLatest(TelemetryFrame& dest) noexcept;
+
+private:
+    static constexpr int capacity = 8;
+
+    juce::AbstractFifo fifo { capacity };
+    std::array<TelemetryFrame, capacity> frames {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TelemetryChannel)
+};
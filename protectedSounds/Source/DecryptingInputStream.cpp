@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    DecryptingInputStream.cpp
+    Created: 17 Oct 2026 12:31:47pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "DecryptingInputStream.h"
+
+// ============================================================================
+// Descifrado en paralelo
+// ============================================================================
+
+void decryptAllChunks(const ChunkDecryptor& decryptor, char* dest, juce::ThreadPool* pool)
+{
+    const auto plainLength = decryptor.getPlainLength();
+    const auto chunkSize = (juce::int64) decryptor.getChunkSize();
+    const auto numChunks = (plainLength + chunkSize - 1) / chunkSize;
+
+    std::atomic<juce::int64> nextChunk { 0 };
+
+    auto decryptPending = [&]
+    {
+        for (auto chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++)
+        {
+            const auto offset = chunk * chunkSize;
+            decryptor.decryptChunk(chunk, dest + offset, (int) juce::jmin(chunkSize, plainLength - offset));
+        }
+    };
+
+    const int numHelpers = pool != nullptr ? (int) juce::jmin((juce::int64) pool->getNumThreads(), numChunks - 1) : 0;
+
+    if (numHelpers <= 0)
+    {
+        decryptPending();
+        return;
+    }
+
+    std::atomic<int> pendingHelpers { numHelpers };
+    juce::WaitableEvent helpersFinished;
+
+    for (int i = 0; i < numHelpers; ++i)
+    {
+        pool->addJob([&]
+        {
+            decryptPending();
+
+            if (--pendingHelpers == 0)
+                helpersFinished.signal();
+        });
+    }
+
+    // El hilo que llama también descifra, y después espera a los ayudantes
+    decryptPending();
+    helpersFinished.wait();
+}
+
+// ============================================================================
+// LegacyBlowfishDecryptor
+// ============================================================================
+
+LegacyBlowfishDecryptor::LegacyBlowfishDecryptor(const void* encryptedData, size_t encryptedSize,
+                                                 const juce::String& key, int chunkSizeBytes)
+    : data(static_cast<const char*>(encryptedData)),
+      size(encryptedSize - encryptedSize % 8),
+      blowfish(key.toUTF8(), (int) key.getNumBytesAsUTF8()),
+      chunkSize(juce::jmax(8, chunkSizeBytes - chunkSizeBytes % 8))
+{
+    plainLength = (juce::int64) size;
+
+    // El tamaño del padding está en el último byte del último bloque
+    if (size >= 8)
+    {
+        char lastBlock[8];
+        decryptRange(size - 8, lastBlock, 8);
+
+        const int paddingSize = lastBlock[7];
+        if (paddingSize > 0 && paddingSize <= 8)
+            plainLength -= paddingSize;
+    }
+}
+
+void LegacyBlowfishDecryptor::decryptChunk(juce::int64 chunkIndex, char* dest, int numBytes) const
+{
+    const auto offset = (size_t) chunkIndex * (size_t) chunkSize;
+    const auto blockBytes = juce::jmin((size_t) chunkSize, size - offset);
+
+    if ((size_t) numBytes == blockBytes)
+    {
+        decryptRange(offset, dest, blockBytes);
+        return;
+    }
+
+    // El último trozo termina dentro del padding: descifrar el bloque completo y recortar
+    char tail[8];
+    const auto wholeBlocks = (size_t) numBytes - (size_t) numBytes % 8;
+    decryptRange(offset, dest, wholeBlocks);
+
+    if (wholeBlocks < (size_t) numBytes)
+    {
+        decryptRange(offset + wholeBlocks, tail, 8);
+        memcpy(dest + wholeBlocks, tail, (size_t) numBytes - wholeBlocks);
+    }
+}
+
+void LegacyBlowfishDecryptor::decryptRange(size_t offset, char* dest, size_t numBytes) const
+{
+    // Desencriptar los datos en bloques de 8 bytes (64 bits)
+    for (size_t i = 0; i < numBytes; i += 8)
+    {
+        juce::uint32 left, right;
+        memcpy(&left, data + offset + i, 4);
+        memcpy(&right, data + offset + i + 4, 4);
+
+        blowfish.decrypt(left, right);
+
+        memcpy(dest + i, &left, 4);
+        memcpy(dest + i + 4, &right, 4);
+    }
+}
+
+// ============================================================================
+// DecryptingInputStream
+// ============================================================================
+
+DecryptingInputStream::DecryptingInputStream(std::unique_ptr<ChunkDecryptor> source)
+    : decryptor(std::move(source))
+{
+    jassert(decryptor != nullptr);
+
+    totalLength = decryptor->getPlainLength();
+    chunkSize = decryptor->getChunkSize();
+    chunkCache.malloc((size_t) chunkSize);
+}
+
+int DecryptingInputStream::getChunkBytes(juce::int64 chunkIndex) const noexcept
+{
+    return (int) juce::jmin((juce::int64) chunkSize, totalLength - chunkIndex * chunkSize);
+}
+
+int DecryptingInputStream::read(void* destBuffer, int maxBytesToRead)
+{
+    auto* dest = static_cast<char*>(destBuffer);
+    int bytesRead = 0;
+
+    while (bytesRead < maxBytesToRead && position < totalLength)
+    {
+        const auto chunkIndex = position / chunkSize;
+        const auto offsetInChunk = (int) (position - chunkIndex * chunkSize);
+        const int chunkBytes = getChunkBytes(chunkIndex);
+        const int bytesToCopy = juce::jmin(chunkBytes - offsetInChunk, maxBytesToRead - bytesRead);
+
+        if (offsetInChunk == 0 && bytesToCopy == chunkBytes && chunkIndex != cachedChunk)
+        {
+            // Trozo completo: descifrar directamente en el destino sin pasar por la caché
+            decryptor->decryptChunk(chunkIndex, dest + bytesRead, chunkBytes);
+        }
+        else
+        {
+            if (chunkIndex != cachedChunk)
+            {
+                decryptor->decryptChunk(chunkIndex, chunkCache.get(), chunkBytes);
+                cachedChunk = chunkIndex;
+            }
+
+            memcpy(dest + bytesRead, chunkCache.get() + offsetInChunk, (size_t) bytesToCopy);
+        }
+
+        bytesRead += bytesToCopy;
+        position += bytesToCopy;
+    }
+
+    return bytesRead;
+}
+
+bool DecryptingInputStream::setPosition(juce::int64 newPosition)
+{
+    // Sólo mueve el cursor; el descifrado ocurre en el siguiente read
+    position = juce::jlimit((juce::int64) 0, totalLength, newPosition);
+    return true;
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    DecryptingInputStream.h
+    Created: 17 Oct 2026 12:31:47pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Fuente de datos cifrados que se puede descifrar por trozos independientes.
+// decryptChunk no modifica el estado, así que varios hilos pueden descifrar trozos distintos a la vez.
+class ChunkDecryptor
+{
+public:
+    virtual ~ChunkDecryptor() = default;
+
+    // Longitud de los datos ya descifrados (sin padding)
+    virtual juce::int64 getPlainLength() const = 0;
+
+    // Tamaño de cada trozo en bytes; el último puede ser más corto
+    virtual int getChunkSize() const = 0;
+
+    // Descifra el trozo chunkIndex; numBytes es el tamaño real de ese trozo
+    virtual void decryptChunk(juce::int64 chunkIndex, char* dest, int numBytes) const = 0;
+};
+
+// Descifra todos los trozos en dest (getPlainLength() bytes) repartiéndolos entre
+// el hilo que llama y los hilos del pool. Con pool == nullptr lo hace en serie.
+void decryptAllChunks(const ChunkDecryptor& decryptor, char* dest, juce::ThreadPool* pool);
+
+// Recursos "_encrypted" antiguos: Blowfish en modo ECB con padding al final.
+// Cada bloque de 8 bytes es independiente, así que cualquier trozo se descifra sin leer los anteriores.
+class LegacyBlowfishDecryptor : public ChunkDecryptor
+{
+public:
+    LegacyBlowfishDecryptor(const void* encryptedData, size_t encryptedSize,
+                            const juce::String& key, int chunkSizeBytes = 16384);
+
+    juce::int64 getPlainLength() const override { return plainLength; }
+    int getChunkSize() const override { return chunkSize; }
+    void decryptChunk(juce::int64 chunkIndex, char* dest, int numBytes) const override;
+
+private:
+    void decryptRange(size_t offset, char* dest, size_t numBytes) const;
+
+    const char* data;
+    size_t size;
+    juce::BlowFish blowfish;
+    int chunkSize;
+    juce::int64 plainLength { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LegacyBlowfishDecryptor)
+};
+
+// InputStream que descifra sólo los trozos que se leen. El AudioFormatReader
+// paga únicamente por las regiones que toca y nunca hay una copia completa en memoria.
+class DecryptingInputStream : public juce::InputStream
+{
+public:
+    explicit DecryptingInputStream(std::unique_ptr<ChunkDecryptor> source);
+
+    juce::int64 getTotalLength() override { return totalLength; }
+    bool isExhausted() override { return position >= totalLength; }
+    int read(void* destBuffer, int maxBytesToRead) override;
+    juce::int64 getPosition() override { return position; }
+    bool setPosition(juce::int64 newPosition) override;
+
+private:
+    int getChunkBytes(juce::int64 chunkIndex) const noexcept;
+
+    std::unique_ptr<ChunkDecryptor> decryptor;
+    juce::int64 totalLength { 0 };
+    juce::int64 position { 0 };
+    int chunkSize { 0 };
+
+    // Último trozo descifrado
+    juce::HeapBlock<char> chunkCache;
+    juce::int64 cachedChunk { -1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DecryptingInputStream)
+};
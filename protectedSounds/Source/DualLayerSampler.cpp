@@ -0,0 +1,959 @@
+/*
+  ==============================================================================
+
+    DualLayerSampler.cpp
+    Created: 17 Oct 2026 10:12:04am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "DualLayerSampler.h"
+
+namespace
+{
+    static_assert(DualLayerSampleData::paddingFrames >= SampleInterpolator::maxFramesBefore
+                   && DualLayerSampleData::paddingFrames >= SampleInterpolator::maxFramesAfter,
+                  "el relleno de la cabeza tiene que cubrir los taps del interpolador");
+    static_assert(VoiceStream::historyFrames >= SampleInterpolator::maxFramesBefore
+                   && VoiceStream::tailFrames >= SampleInterpolator::maxFramesAfter
+                   && VoiceStream::guardFrames > SampleInterpolator::maxFramesBefore + SampleInterpolator::maxFramesAfter,
+                  "los márgenes del ring tienen que cubrir los taps del interpolador");
+
+    // Ganancias de la mezcla repartidas en los carriles [cleanL, excitedL, cleanR, excitedR]
+    inline void setLaneGains(float* laneGains, float cleanGain, float excitedGain) noexcept
+    {
+        laneGains[0] = laneGains[2] = cleanGain;
+        laneGains[1] = laneGains[3] = excitedGain;
+    }
+
+    // Región de loop de una voz expresada en frames del sonido que está sonando
+    struct LoopRegion
+    {
+        bool active = false;
+        double start = 0.0;
+        double end = 0.0;
+        double length = 0.0;
+        double crossfade = 0.0;
+        double seamStart = 0.0;
+    };
+
+    LoopRegion makeLoopRegion(const DualLayerRenderState& state, double sourceSampleRate, int soundLength) noexcept
+    {
+        LoopRegion region;
+
+        if (! state.loopEnabled || soundLength < 2)
+            return region;
+
+        region.start = juce::jlimit(0.0, (double) soundLength - 1.0, state.loopStartSeconds * sourceSampleRate);
+        region.end = juce::jlimit(region.start + 1.0, (double) soundLength, state.loopEndSeconds * sourceSampleRate);
+        region.length = region.end - region.start;
+
+        // El crossfade lee antes de loopStart, así que no puede ser más largo que eso
+        region.crossfade = juce::jmin(state.loopCrossfadeSeconds * sourceSampleRate,
+                                      region.start, region.length * 0.5);
+        region.seamStart = region.end - region.crossfade;
+        region.active = true;
+        return region;
+    }
+
+    // El streamer trabaja con frames enteros
+    StreamLoop makeStreamLoop(const LoopRegion& region) noexcept
+    {
+        StreamLoop loop;
+
+        if (! region.active)
+            return loop;
+
+        loop.start = juce::roundToInt(region.start);
+        loop.end = juce::jmax(loop.start + 1, (juce::int64) juce::roundToInt(region.end));
+        loop.crossfade = juce::jmin((juce::int64) region.crossfade, loop.start, (loop.end - loop.start) / 2);
+        loop.active = true;
+        return loop;
+    }
+}
+
+// ============================================================================
+// DualLayerSampleData
+// ============================================================================
+
+bool DualLayerSampleData::isResident(const juce::AudioFormatReader& cleanSource, const juce::AudioFormatReader& excitedSource)
+{
+    const auto fullLength = juce::jmax(cleanSource.lengthInSamples, excitedSource.lengthInSamples);
+    return fullLength <= (juce::int64) (maxResidentSeconds * cleanSource.sampleRate);
+}
+
+DualLayerSampleData::DualLayerSampleData(const juce::String& soundName,
+                                         juce::AudioFormatReader& cleanSource,
+                                         juce::AudioFormatReader& excitedSource,
+                                         DualLayerReaderFactory streamFactory,
+                                         double targetSampleRate)
+    : name(soundName),
+      sourceSampleRate(cleanSource.sampleRate)
+{
+    if (sourceSampleRate <= 0.0 || cleanSource.lengthInSamples <= 0)
+        return;
+
+    // Las dos versiones se leen a la frecuencia de la clean; si una es más corta se rellena con silencio
+    const auto fullLength = juce::jmax(cleanSource.lengthInSamples, excitedSource.lengthInSamples);
+    length = (int) juce::jmin(fullLength, (juce::int64) std::numeric_limits<int>::max() - 1);
+    headLength = length;
+
+    if (streamFactory != nullptr && ! isResident(cleanSource, excitedSource))
+    {
+        headLength = (int) (streamHeadSeconds * sourceSampleRate);
+        streamReaders = std::move(streamFactory);
+    }
+
+    juce::AudioBuffer<float> clean(2, headLength);
+    juce::AudioBuffer<float> excited(2, headLength);
+    cleanSource.read(&clean, 0, headLength, 0, true, true);
+    excitedSource.read(&excited, 0, headLength, 0, true, true);
+
+    allocateFrames(headLength);
+
+    const float* cleanL = clean.getReadPointer(0);
+    const float* cleanR = clean.getReadPointer(1);
+    const float* excitedL = excited.getReadPointer(0);
+    const float* excitedR = excited.getReadPointer(1);
+
+    for (int i = 0; i < headLength; ++i)
+    {
+        float* frame = frames + (size_t) i * numLanes;
+        frame[0] = cleanL[i];
+        frame[1] = excitedL[i];
+        frame[2] = cleanR[i];
+        frame[3] = excitedR[i];
+    }
+
+    if (targetSampleRate > 0.0 && targetSampleRate != sourceSampleRate && ! isStreamed())
+        resampleTo(targetSampleRate);
+}
+
+void DualLayerSampleData::allocateFrames(int numFrames)
+{
+    // Silencio antes y después para los taps del interpolador + margen para alinear a SIMD
+   #if JUCE_USE_SIMD
+    const size_t alignmentPadding = juce::dsp::SIMDRegister<float>::SIMDRegisterSize / sizeof(float);
+   #else
+    const size_t alignmentPadding = 0;
+   #endif
+
+    frameStorage.calloc((size_t) (numFrames + 2 * paddingFrames) * numLanes + alignmentPadding);
+
+   #if JUCE_USE_SIMD
+    frames = juce::dsp::SIMDRegister<float>::getNextSIMDAlignedPtr(frameStorage.get());
+   #else
+    frames = frameStorage.get();
+   #endif
+
+    frames += (size_t) paddingFrames * numLanes;
+}
+
+void DualLayerSampleData::resampleTo(double targetSampleRate)
+{
+    // Con el mismo interpolador sinc que las voces: al bajar de frecuencia su banda ya filtra
+    // lo que quedaría por encima del nuevo Nyquist
+    const auto ratio = sourceSampleRate / targetSampleRate;
+    const auto newLength = (int) juce::jmin((double) std::numeric_limits<int>::max() - 1,
+                                            std::ceil((double) length / ratio));
+
+    juce::HeapBlock<float> sourceStorage;
+    sourceStorage.swapWith(frameStorage);
+    const float* source = frames;
+
+    allocateFrames(newLength);
+
+    SampleInterpolator interpolator;
+    interpolator.prepare(SampleInterpolator::Mode::sinc, ratio);
+    alignas(16) const float unityGains[numLanes] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    for (int i = 0; i < newLength; ++i)
+    {
+        const auto position = (double) i * ratio;
+        const auto pos = juce::jmin((int) position, length - 1);
+        interpolator.process(source + (size_t) pos * numLanes, (float) (position - pos), unityGains,
+                             frames + (size_t) i * numLanes);
+    }
+
+    length = headLength = newLength;
+    sourceSampleRate = targetSampleRate;
+}
+
+// ============================================================================
+// DualLayerSound
+// ============================================================================
+
+DualLayerSound::DualLayerSound(const juce::BigInteger& notes, int midiNoteForNormalPitch)
+    : midiNotes(notes),
+      midiRootNote(midiNoteForNormalPitch)
+{
+}
+
+DualLayerSound::~DualLayerSound()
+{
+    collectGarbage();
+
+    if (auto* data = pending.exchange(nullptr))
+        data->decReferenceCount();
+
+    if (current.data != nullptr)
+        current.data->decReferenceCount();
+
+    for (auto& slot : retiring)
+        if (slot.data != nullptr)
+            slot.data->decReferenceCount();
+}
+
+void DualLayerSound::publish(DualLayerSampleData::Ptr newData)
+{
+    if (newData == nullptr)
+        return;
+
+    // La referencia viaja con el puntero; si había otros datos pendientes, el hilo de audio nunca llegó a verlos
+    newData->incReferenceCount();
+
+    if (auto* previous = pending.exchange(newData.get(), std::memory_order_acq_rel))
+        previous->decReferenceCount();
+}
+
+void DualLayerSound::collectGarbage()
+{
+    const auto scope = retiredFifo.read(retiredFifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        retired[(size_t) (scope.startIndex1 + i)]->decReferenceCount();
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        retired[(size_t) (scope.startIndex2 + i)]->decReferenceCount();
+}
+
+bool DualLayerSound::retire(DualLayerSampleData* data) noexcept
+{
+    if (retiredFifo.getFreeSpace() == 0)
+        return false;
+
+    const auto scope = retiredFifo.write(1);
+    retired[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)] = data;
+    return true;
+}
+
+DualLayerSound::DataSlot* DualLayerSound::findSlot(DualLayerSampleData& data) noexcept
+{
+    if (current.data == &data)
+        return &current;
+
+    for (auto& slot : retiring)
+        if (slot.data == &data)
+            return &slot;
+
+    return nullptr;
+}
+
+void DualLayerSound::voiceStarted(DualLayerSampleData& data) noexcept
+{
+    if (auto* slot = findSlot(data))
+        ++slot->activeVoices;
+}
+
+void DualLayerSound::voiceStopped(DualLayerSampleData& data) noexcept
+{
+    if (auto* slot = findSlot(data))
+        --slot->activeVoices;
+}
+
+void DualLayerSound::retireUnusedData()
+{
+    for (auto& slot : retiring)
+    {
+        if (slot.data == nullptr || slot.activeVoices > 0 || ! retire(slot.data))
+            continue;
+
+        slot = {};
+    }
+}
+
+void DualLayerSound::updateCurrentData()
+{
+    retireUnusedData();
+
+    auto* newData = pending.load(std::memory_order_acquire);
+
+    if (newData == nullptr)
+        return;
+
+    // Los mismos datos que ya suenan (p. ej. vuelven de la caché): sobra la referencia nueva
+    if (newData == current.data)
+    {
+        if (retiredFifo.getFreeSpace() > 0 && pending.compare_exchange_strong(newData, nullptr, std::memory_order_acq_rel))
+            retire(newData);
+
+        return;
+    }
+
+    // Si los datos nuevos estaban retirándose, vuelven a ser los actuales con sus voces;
+    // si no, hace falta un hueco libre para retirar los actuales. Si algo no cabe se reintenta
+    // en el siguiente bloque.
+    auto reused = std::find_if(retiring.begin(), retiring.end(), [newData](const DataSlot& slot) { return slot.data == newData; });
+    auto freeSlot = reused != retiring.end() ? reused
+                                              : std::find_if(retiring.begin(), retiring.end(), [](const DataSlot& slot) { return slot.data == nullptr; });
+
+    if (current.data != nullptr && freeSlot == retiring.end())
+        return;
+
+    if (reused != retiring.end() && retiredFifo.getFreeSpace() == 0)
+        return;
+
+    if (! pending.compare_exchange_strong(newData, nullptr, std::memory_order_acq_rel))
+        return;
+
+    DataSlot adopted { newData, 0 };
+
+    if (reused != retiring.end())
+    {
+        retire(reused->data); // la referencia del slot; queda la que venía con la publicación
+        adopted.activeVoices = reused->activeVoices;
+        *reused = {};
+    }
+
+    if (current.data != nullptr)
+        *freeSlot = current;
+
+    current = adopted;
+}
+
+// ============================================================================
+// VoiceStateTable
+// ============================================================================
+
+void VoiceStateTable::resize(int numVoices)
+{
+    const auto size = (size_t) numVoices;
+
+    position.assign(size, 0.0);
+    increment.assign(size, 0.0);
+    envelope.assign(size, 0.0f);
+    gain.assign(size, 0.0f);
+    noteOnOrder.assign(size, 0);
+    releasing.assign(size, 0);
+}
+
+// ============================================================================
+// DualLayerVoice
+// ============================================================================
+
+DualLayerVoice::DualLayerVoice(const DualLayerRenderState& state, SampleStreamer& streamer, VoiceStateTable& table, int slotIndex)
+    : renderState(state),
+      sampleStreamer(streamer),
+      voiceState(table),
+      slot((size_t) slotIndex)
+{
+    sampleStreamer.registerStream(stream);
+}
+
+DualLayerVoice::~DualLayerVoice()
+{
+    sampleStreamer.unregisterStream(stream);
+}
+
+bool DualLayerVoice::canPlaySound(juce::SynthesiserSound* sound)
+{
+    return dynamic_cast<const DualLayerSound*>(sound) != nullptr;
+}
+
+void DualLayerVoice::startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound* s, int)
+{
+    auto* sound = dynamic_cast<DualLayerSound*>(s);
+
+    if (sound == nullptr)
+    {
+        jassertfalse; // this object can only play DualLayerSounds!
+        return;
+    }
+
+    // Sin datos cargados no hay nada que reproducir
+    playingData = sound->getCurrentData();
+
+    if (playingData == nullptr || playingData->getLength() == 0)
+    {
+        playingData = nullptr;
+        clearCurrentNote();
+        return;
+    }
+
+    sound->voiceStarted(*playingData);
+
+    const auto pitchRatio = std::pow(2.0, (midiNoteNumber - sound->getMidiRootNote()) / 12.0)
+                              * playingData->getSourceSampleRate() / getSampleRate();
+
+    voiceState.position[slot] = 0.0;
+    voiceState.increment[slot] = pitchRatio;
+    streaming = playingData->isStreamed();
+    interpolator.prepare(renderState.interpolationMode, pitchRatio);
+
+    if (streaming)
+    {
+        // El loop se fija aquí; la cabeza se lee hasta la costura y lo demás llega del streamer
+        const auto loop = makeStreamLoop(makeLoopRegion(renderState, playingData->getSourceSampleRate(),
+                                                        playingData->getLength()));
+        headLimit = playingData->getHeadLength();
+
+        if (loop.active)
+            headLimit = juce::jmin(headLimit, loop.end - loop.crossfade);
+
+        stream.start(*playingData, headLimit, loop);
+        streamLoop = loop;
+    }
+
+    voiceState.gain[slot] = velocity;
+    voiceState.envelope[slot] = 0.0f;
+    voiceState.noteOnOrder[slot] = voiceState.nextNoteOnOrder();
+    voiceState.releasing[slot] = 0;
+
+    // La envolvente avanza una vez por sample de salida
+    // Los coeficientes del filtro llegan del sintetizador antes del primer sample
+    filter.reset();
+
+    envelopeParameters = sound->getEnvelopeParameters();
+    samplesSinceNoteOn = 0;
+
+    adsr.setSampleRate(getSampleRate());
+    adsr.setParameters(envelopeParameters);
+    adsr.noteOn();
+}
+
+void DualLayerVoice::stopNote(float, bool allowTailOff)
+{
+    if (allowTailOff)
+    {
+        adsr.noteOff();
+        voiceState.releasing[slot] = 1;
+    }
+    else
+        finishNote();
+}
+
+void DualLayerVoice::finishNote()
+{
+    // Soltar los datos antes de clearCurrentNote, que olvida el sonido.
+    // El stream se para antes de voiceStopped para que el streamer deje de usar los datos.
+    if (playingData != nullptr)
+    {
+        if (streaming)
+            stream.stop();
+
+        streaming = false;
+        streamLoop = {};
+
+        if (auto* sound = static_cast<DualLayerSound*>(getCurrentlyPlayingSound().get()))
+            sound->voiceStopped(*playingData);
+
+        playingData = nullptr;
+    }
+
+    clearCurrentNote();
+    adsr.reset();
+    voiceState.envelope[slot] = 0.0f;
+    voiceState.noteOnOrder[slot] = 0;
+    voiceState.releasing[slot] = 0;
+}
+
+void DualLayerVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    if (playingData == nullptr)
+        return;
+
+    float* outL = outputBuffer.getWritePointer(0, startSample);
+    float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer(1, startSample) : nullptr;
+
+    samplesSinceNoteOn += numSamples;
+
+    // Rampa de la mezcla alineada con este trozo del buffer
+    const float* cleanRamp = nullptr;
+    const float* excitedRamp = nullptr;
+
+    if (renderState.cleanGainRamp != nullptr)
+    {
+        const auto offset = startSample - renderState.rampStartSample;
+        cleanRamp = renderState.cleanGainRamp + offset;
+        excitedRamp = renderState.excitedGainRamp + offset;
+    }
+
+    if (streaming)
+        renderStreamed(outL, outR, numSamples, cleanRamp, excitedRamp);
+    else
+        renderResident(outL, outR, numSamples, cleanRamp, excitedRamp);
+}
+
+void DualLayerVoice::renderResident(float* outL, float* outR, int numSamples, const float* cleanRamp, const float* excitedRamp)
+{
+    const float* frames = playingData->getFrameData();
+    const int length = playingData->getLength();
+    constexpr int lanes = DualLayerSampleData::numLanes;
+
+    const auto loop = makeLoopRegion(renderState, playingData->getSourceSampleRate(), length);
+
+    // Ganancias por carril: [cleanL, excitedL, cleanR, excitedR]
+    const float clean = renderState.cleanGain;
+    const float excited = renderState.excitedGain;
+    alignas(16) float laneGains[lanes] = { clean, excited, clean, excited };
+    alignas(16) float seamGains[lanes];
+    alignas(16) float mixed[lanes];
+    alignas(16) float seamMixed[lanes];
+
+    // El estado de la tabla se trabaja en locales y se devuelve al terminar el bloque
+    double position = voiceState.position[slot];
+    const double increment = voiceState.increment[slot];
+    const float gain = voiceState.gain[slot];
+    float envelopeValue = voiceState.envelope[slot];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (cleanRamp != nullptr)
+            setLaneGains(laneGains, cleanRamp[i], excitedRamp[i]);
+
+        const auto pos = (int) position;
+        const auto alpha = (float) (position - pos);
+        const float* frame = frames + (size_t) pos * lanes;
+
+        if (loop.active && loop.crossfade > 0.0 && position >= loop.seamStart)
+        {
+            // Costura del loop: se funde el final con lo que precede a loopStart (potencia constante)
+            const auto fade = juce::jmin(1.0f, (float) ((position - loop.seamStart) / loop.crossfade));
+            const float fadeOut = std::cos(fade * juce::MathConstants<float>::halfPi);
+            const float fadeIn = std::sin(fade * juce::MathConstants<float>::halfPi);
+
+            const double seamPosition = position - loop.length;
+            const auto seamPos = (int) seamPosition;
+            const float* seamFrame = frames + (size_t) seamPos * lanes;
+
+            for (int lane = 0; lane < lanes; ++lane)
+                seamGains[lane] = laneGains[lane] * fadeIn;
+
+            interpolator.process(frame, alpha, laneGains, mixed);
+            interpolator.process(seamFrame, (float) (seamPosition - seamPos), seamGains, seamMixed);
+
+            for (int lane = 0; lane < lanes; ++lane)
+                mixed[lane] = mixed[lane] * fadeOut + seamMixed[lane];
+        }
+        else
+        {
+            interpolator.process(frame, alpha, laneGains, mixed);
+        }
+
+        envelopeValue = adsr.getNextSample();
+        float l = (mixed[0] + mixed[1]) * gain * envelopeValue;
+        float r = (mixed[2] + mixed[3]) * gain * envelopeValue;
+
+        if (renderState.filterEnabled)
+            filter.process(renderState.filterType, l, r);
+
+        if (outR != nullptr)
+        {
+            outL[i] += l;
+            outR[i] += r;
+        }
+        else
+        {
+            outL[i] += (l + r) * 0.5f;
+        }
+
+        position += increment;
+
+        // Salto del loop conservando la fase fraccional
+        if (loop.active && position >= loop.end)
+            position = loop.start + std::fmod(position - loop.start, loop.length);
+
+        if (position >= length || ! adsr.isActive())
+        {
+            finishNote();
+            return;
+        }
+    }
+
+    voiceState.position[slot] = position;
+    voiceState.envelope[slot] = envelopeValue;
+}
+
+const float* DualLayerVoice::getStreamedFrames(juce::int64 logicalFrame) noexcept
+{
+    constexpr int lanes = DualLayerSampleData::numLanes;
+    const auto first = logicalFrame - interpolator.getFramesBefore();
+    const auto last = logicalFrame + interpolator.getFramesAfter();
+
+    // Todos los taps en la cabeza (antes del frame 0 está el relleno de silencio)
+    if (last < headLimit)
+        return playingData->getFrameData() + (size_t) logicalFrame * lanes;
+
+    // Todos en el ring, contiguos gracias a sus frames de guarda
+    if (first >= headLimit)
+    {
+        const float* taps = stream.getFrames(first, last);
+        return taps != nullptr ? taps + (size_t) interpolator.getFramesBefore() * lanes : nullptr;
+    }
+
+    // Cruzan de la cabeza al ring: sólo pasa durante unos pocos samples por nota
+    const float* ringTaps = stream.getFrames(headLimit, last);
+
+    if (ringTaps == nullptr)
+        return nullptr;
+
+    const auto numHeadTaps = (int) (headLimit - first);
+    const auto numRingTaps = (int) (last - headLimit + 1);
+    const float* headTaps = playingData->getFrameData() + (std::ptrdiff_t) first * lanes;
+
+    std::copy(headTaps, headTaps + numHeadTaps * lanes, tapScratch);
+    std::copy(ringTaps, ringTaps + numRingTaps * lanes, tapScratch + numHeadTaps * lanes);
+
+    return tapScratch + interpolator.getFramesBefore() * lanes;
+}
+
+void DualLayerVoice::renderStreamed(float* outL, float* outR, int numSamples, const float* cleanRamp, const float* excitedRamp)
+{
+    constexpr int lanes = DualLayerSampleData::numLanes;
+
+    // Sin loop la nota acaba al final del sonido; con loop la posición lógica sigue creciendo
+    const bool looping = stream.isLooping();
+    const auto length = (double) playingData->getLength();
+
+    const float clean = renderState.cleanGain;
+    const float excited = renderState.excitedGain;
+    alignas(16) float laneGains[lanes] = { clean, excited, clean, excited };
+    alignas(16) float mixed[lanes];
+
+    double position = voiceState.position[slot];
+    const double increment = voiceState.increment[slot];
+    const float gain = voiceState.gain[slot];
+    float envelopeValue = voiceState.envelope[slot];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (cleanRamp != nullptr)
+            setLaneGains(laneGains, cleanRamp[i], excitedRamp[i]);
+
+        const auto pos = (juce::int64) position;
+        const float* frame = getStreamedFrames(pos);
+        envelopeValue = adsr.getNextSample();
+
+        // Si el streamer no ha llegado, la posición se congela (silencio) en vez de saltar audio
+        if (frame != nullptr)
+        {
+            interpolator.process(frame, (float) (position - (double) pos), laneGains, mixed);
+
+            float l = (mixed[0] + mixed[1]) * gain * envelopeValue;
+            float r = (mixed[2] + mixed[3]) * gain * envelopeValue;
+
+            if (renderState.filterEnabled)
+                filter.process(renderState.filterType, l, r);
+
+            if (outR != nullptr)
+            {
+                outL[i] += l;
+                outR[i] += r;
+            }
+            else
+            {
+                outL[i] += (l + r) * 0.5f;
+            }
+
+            position += increment;
+        }
+
+        if ((! looping && position >= length) || ! adsr.isActive())
+        {
+            finishNote();
+            return;
+        }
+    }
+
+    voiceState.position[slot] = position;
+    voiceState.envelope[slot] = envelopeValue;
+    stream.setReadPosition((juce::int64) position);
+}
+
+bool DualLayerVoice::isStreamBuffered(int numSamples) const noexcept
+{
+    if (! streaming || playingData == nullptr)
+        return true;
+
+    // Último tap que puede leer el trozo; sin loop, el ring se acaba tras el silencio del final
+    auto last = (juce::int64) (voiceState.position[slot] + voiceState.increment[slot] * numSamples)
+                  + interpolator.getFramesAfter() + 1;
+
+    if (! streamLoop.active)
+        last = juce::jmin(last, playingData->getLength() + VoiceStream::tailFrames - 1);
+
+    return last < headLimit || stream.hasFramesUpTo(last);
+}
+
+VoiceTelemetry DualLayerVoice::getTelemetry() const noexcept
+{
+    VoiceTelemetry telemetry;
+
+    if (playingData == nullptr)
+        return telemetry;
+
+    const auto length = playingData->getLength();
+    auto position = voiceState.position[slot];
+
+    // En streaming la posición es lógica: pasada la costura se pliega dentro del loop
+    if (streaming && streamLoop.active && position >= (double) streamLoop.end)
+        position = (double) streamLoop.start + std::fmod(position - (double) streamLoop.end,
+                                                         (double) (streamLoop.end - streamLoop.start));
+
+    telemetry.midiNote = getCurrentlyPlayingNote();
+    telemetry.position = (float) juce::jlimit(0.0, 1.0, position / (double) juce::jmax(1, length));
+    telemetry.level = voiceState.envelope[slot];
+
+    const auto seconds = (double) samplesSinceNoteOn / getSampleRate();
+
+    if (voiceState.releasing[slot] != 0)
+        telemetry.stage = VoiceTelemetry::Stage::release;
+    else if (seconds < envelopeParameters.attack)
+        telemetry.stage = VoiceTelemetry::Stage::attack;
+    else if (seconds < envelopeParameters.attack + envelopeParameters.decay)
+        telemetry.stage = VoiceTelemetry::Stage::decay;
+    else
+        telemetry.stage = VoiceTelemetry::Stage::sustain;
+
+    return telemetry;
+}
+
+// ============================================================================
+// DualLayerSynthesiser
+// ============================================================================
+
+DualLayerSynthesiser::DualLayerSynthesiser(int maxVoices, SampleStreamer& streamer)
+{
+    voiceState.resize(maxVoices);
+
+    for (int i = 0; i < maxVoices; ++i)
+        addVoice(new DualLayerVoice(renderState, streamer, voiceState, i));
+
+    polyphony = maxVoices;
+    filterCutoffs.resize((size_t) maxVoices);
+    filterCoefficients.resize((size_t) maxVoices);
+    cutoffSmoother.reset(44100.0, 0.02, std::log2(1000.0f));
+
+    // Un único sonido para todo el rango MIDI; lo que cambia al cargar son sus datos
+    juce::BigInteger range;
+    range.setRange(0, 128, true);
+    sound = static_cast<DualLayerSound*>(addSound(new DualLayerSound(range, 60)));
+}
+
+DualLayerSynthesiser::~DualLayerSynthesiser()
+{
+    // Synthesiser destruye antes los sonidos que las voces: las voces (y sus streams) se
+    // quitan primero para que el streamer no toque datos ya liberados
+    clearVoices();
+}
+
+void DualLayerSynthesiser::setMixGains(float cleanGain, float excitedGain) noexcept
+{
+    renderState.cleanGain = cleanGain;
+    renderState.excitedGain = excitedGain;
+    renderState.cleanGainRamp = nullptr;
+    renderState.excitedGainRamp = nullptr;
+}
+
+void DualLayerSynthesiser::setMixGainRamp(const float* cleanGains, const float* excitedGains, int firstSample) noexcept
+{
+    renderState.cleanGainRamp = cleanGains;
+    renderState.excitedGainRamp = excitedGains;
+    renderState.rampStartSample = firstSample;
+}
+
+void DualLayerSynthesiser::setLoop(bool enabled, double startSeconds, double endSeconds, double crossfadeSeconds) noexcept
+{
+    renderState.loopEnabled = enabled;
+    renderState.loopStartSeconds = startSeconds;
+    renderState.loopEndSeconds = endSeconds;
+    renderState.loopCrossfadeSeconds = crossfadeSeconds;
+}
+
+void DualLayerSynthesiser::setEnvelopeParameters(const juce::ADSR::Parameters& parametersToUse)
+{
+    sound->setEnvelopeParameters(parametersToUse);
+}
+
+void DualLayerSynthesiser::setCurrentPlaybackSampleRate(double newRate)
+{
+    juce::Synthesiser::setCurrentPlaybackSampleRate(newRate);
+    cutoffSmoother.reset(newRate, 0.02, cutoffSmoother.getTargetValue());
+}
+
+void DualLayerSynthesiser::setFilter(bool enabled, VoiceFilter::Type type, float cutoffHz, float resonance,
+                                     float envelopeOctaves, float velocityOctaves) noexcept
+{
+    // Al activarlo, los filtros de las voces que ya suenan arrancan desde cero y sin rampa
+    if (enabled && ! renderState.filterEnabled)
+        for (int i = 0; i < getNumVoices(); ++i)
+            static_cast<DualLayerVoice*>(getVoice(i))->resetFilter();
+
+    renderState.filterEnabled = enabled;
+    renderState.filterType = type;
+    cutoffSmoother.setTargetValue(std::log2(juce::jmax(1.0f, cutoffHz)));
+    filterResonance = resonance;
+    filterEnvelopeOctaves = envelopeOctaves;
+    filterVelocityOctaves = velocityOctaves;
+}
+
+bool DualLayerSynthesiser::isStreamBuffered(int numSamples) const noexcept
+{
+    // Todas las voces, también las que pasan del límite de polifonía y aún terminan su nota
+    for (auto* voice : voices)
+        if (! static_cast<const DualLayerVoice*>(voice)->isStreamBuffered(numSamples))
+            return false;
+
+    return true;
+}
+
+void DualLayerSynthesiser::renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    if (! renderState.filterEnabled)
+    {
+        juce::Synthesiser::renderVoices(outputAudio, startSample, numSamples);
+        return;
+    }
+
+    const auto endSample = startSample + numSamples;
+
+    for (int segmentStart = startSample; segmentStart < endSample; segmentStart += filterControlInterval)
+    {
+        const auto segmentSamples = juce::jmin(filterControlInterval, endSample - segmentStart);
+
+        updateFilterCoefficients(segmentSamples);
+        juce::Synthesiser::renderVoices(outputAudio, segmentStart, segmentSamples);
+    }
+}
+
+#if PROTECTEDSOUNDS_INSTRUMENTATION
+void DualLayerSynthesiser::handleMidiEvent(const juce::MidiMessage& message)
+{
+    // Note on (con el robo de voces), note off y controladores; renderNextBlock los intercala con el render
+    PROTECTEDSOUNDS_INSTRUMENT_CYCLES(midiCycles);
+    juce::Synthesiser::handleMidiEvent(message);
+}
+#endif
+
+void DualLayerSynthesiser::updateFilterCoefficients(int numSamples) noexcept
+{
+    // Objetivo al final del tramo: corte base suavizado más la modulación de cada voz.
+    // Se calcula para toda la tabla de una vez (las voces libres no cuestan más que el hueco)
+    const auto baseOctaves = cutoffSmoother.skip(numSamples);
+    const auto numVoices = voiceState.size();
+    auto* cutoffs = filterCutoffs.data();
+
+    juce::FloatVectorOperations::fill(cutoffs, baseOctaves, numVoices);
+    juce::FloatVectorOperations::addWithMultiply(cutoffs, voiceState.envelope.data(), filterEnvelopeOctaves, numVoices);
+    juce::FloatVectorOperations::addWithMultiply(cutoffs, voiceState.gain.data(), filterVelocityOctaves, numVoices);
+
+    for (int i = 0; i < numVoices; ++i)
+        cutoffs[i] = std::exp2(cutoffs[i]);
+
+    VoiceFilter::computeCoefficients(cutoffs, filterResonance, getSampleRate(), filterCoefficients.data(), numVoices);
+
+    for (int i = 0; i < numVoices; ++i)
+        if (voiceState.noteOnOrder[(size_t) i] != 0)
+            static_cast<DualLayerVoice*>(voices.getUnchecked(i))->setFilterTarget(filterCoefficients[(size_t) i], numSamples);
+}
+
+// ============================================================================
+// Asignación y robo de voces
+// ============================================================================
+
+juce::SynthesiserVoice* DualLayerSynthesiser::findFreeVoice(juce::SynthesiserSound* soundToPlay, int midiChannel,
+                                                            int midiNoteNumber, bool stealIfNoneAvailable) const
+{
+    // Siempre primero una voz libre: la de la misma nota ya está en release (noteOn la ha mandado
+    // a la cola) y reiniciarla la cortaría de golpe, con un click en cada nota repetida
+    for (int i = 0; i < polyphony; ++i)
+        if (! voices.getUnchecked(i)->isVoiceActive() && voices.getUnchecked(i)->canPlaySound(soundToPlay))
+            return voices.getUnchecked(i);
+
+    if (stealIfNoneAvailable)
+        return findVoiceToSteal(soundToPlay, midiChannel, midiNoteNumber);
+
+    return nullptr;
+}
+
+juce::SynthesiserVoice* DualLayerSynthesiser::findVoiceToSteal(juce::SynthesiserSound*, int midiChannel,
+                                                               int midiNoteNumber) const
+{
+    // Sin voces libres, repetir una nota se queda con la voz que la estaba tocando
+    if (stealingPolicy == StealingPolicy::sameNote)
+        for (int i = 0; i < polyphony; ++i)
+            if (voices.getUnchecked(i)->getCurrentlyPlayingNote() == midiNoteNumber
+                 && voices.getUnchecked(i)->isPlayingChannel(midiChannel))
+                return voices.getUnchecked(i);
+
+    // Todas las voces pueden tocar el único DualLayerSound; la elección sólo mira la tabla
+    const auto index = stealingPolicy == StealingPolicy::quietest ? findQuietestVoice() : findOldestVoice();
+    return index >= 0 ? voices.getUnchecked(index) : nullptr;
+}
+
+int DualLayerSynthesiser::findOldestVoice() const noexcept
+{
+    // Las voces en release van antes: ya se están apagando
+    int oldest = -1;
+    int oldestReleasing = -1;
+
+    for (int i = 0; i < polyphony; ++i)
+    {
+        const auto order = voiceState.noteOnOrder[(size_t) i];
+
+        if (order == 0)
+            continue;
+
+        if (oldest < 0 || order < voiceState.noteOnOrder[(size_t) oldest])
+            oldest = i;
+
+        if (voiceState.releasing[(size_t) i] != 0
+             && (oldestReleasing < 0 || order < voiceState.noteOnOrder[(size_t) oldestReleasing]))
+            oldestReleasing = i;
+    }
+
+    return oldestReleasing >= 0 ? oldestReleasing : oldest;
+}
+
+int DualLayerSynthesiser::findQuietestVoice() const noexcept
+{
+    int quietest = -1;
+    float quietestLevel = std::numeric_limits<float>::max();
+
+    for (int i = 0; i < polyphony; ++i)
+    {
+        if (voiceState.noteOnOrder[(size_t) i] == 0)
+            continue;
+
+        const auto level = voiceState.envelope[(size_t) i] * voiceState.gain[(size_t) i];
+
+        if (level < quietestLevel)
+        {
+            quietest = i;
+            quietestLevel = level;
+        }
+    }
+
+    return quietest;
+}
+
+void DualLayerSynthesiser::fillTelemetry(TelemetryFrame& frame, int layer) const noexcept
+{
+    for (int i = 0; i < getNumVoices(); ++i)
+    {
+        auto* voice = static_cast<const DualLayerVoice*>(getVoice(i));
+
+        if (voice == nullptr || ! voice->isVoiceActive())
+            continue;
+
+        ++frame.numActiveVoices;
+
+        if (frame.numVoices == TelemetryFrame::maxVoices)
+            continue;
+
+        auto telemetry = voice->getTelemetry();
+        telemetry.layer = layer;
+        frame.voices[(size_t) frame.numVoices++] = telemetry;
+    }
+}
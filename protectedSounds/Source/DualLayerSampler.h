@@ -0,0 +1,357 @@
+/*
+  ==============================================================================
+
+    DualLayerSampler.h
+    Created: 17 Oct 2026 10:12:04am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SampleStreamer.h"
+#include "AudioTelemetry.h"
+#include "ParameterSmoothing.h"
+#include "VoiceFilter.h"
+#include "SampleInterpolator.h"
+#include "ProcessingInstrumentation.h"
+
+// Estado compartido por todas las voces de un DualLayerSynthesiser.
+// Lo escribe el hilo de audio antes de renderizar cada bloque.
+struct DualLayerRenderState
+{
+    // Ganancias de cada capa según MixAmount (crossfade de potencia constante)
+    float cleanGain = juce::MathConstants<float>::sqrt2 * 0.5f;
+    float excitedGain = juce::MathConstants<float>::sqrt2 * 0.5f;
+
+    // Mientras MixAmount está en rampa las ganancias van por sample: ramp[i] corresponde al
+    // sample rampStartSample + i del buffer de salida. nullptr = ganancias constantes.
+    const float* cleanGainRamp = nullptr;
+    const float* excitedGainRamp = nullptr;
+    int rampStartSample = 0;
+
+    // Filtro de cada voz; los coeficientes los pone el sintetizador (ver DualLayerSynthesiser)
+    bool filterEnabled = false;
+    VoiceFilter::Type filterType = VoiceFilter::Type::lowpass;
+
+    // Calidad de la interpolación; cada voz la fija al empezar la nota
+    SampleInterpolator::Mode interpolationMode = SampleInterpolator::Mode::hermite;
+
+    // Loop en segundos del sample; cada voz lo convierte a frames de su sonido
+    bool loopEnabled = false;
+    double loopStartSeconds = 0.0;
+    double loopEndSeconds = 0.0;
+    double loopCrossfadeSeconds = 0.0;
+};
+
+// Abre lectores nuevos de las dos versiones de un sonido; la usa el streamer en su hilo
+using DualLayerReaderPair = std::pair<std::unique_ptr<juce::AudioFormatReader>, std::unique_ptr<juce::AudioFormatReader>>;
+using DualLayerReaderFactory = std::function<DualLayerReaderPair()>;
+
+// Versiones clean y excited de una muestra, ya decodificadas. Inmutable una vez publicada.
+// Los datos se guardan entrelazados por frame como [cleanL, excitedL, cleanR, excitedR]
+// para que la voz lea las dos capas con una sola carga SIMD de 4 floats.
+// Los sonidos largos no se cargan enteros: sólo se guarda el ataque (la cabeza) y el resto
+// lo lee el SampleStreamer con los lectores que devuelve streamFactory.
+// Con targetSampleRate los sonidos en memoria se convierten una vez, al cargarlos, a la
+// frecuencia del host; así las voces no convierten nada en cada nota y en la nota raíz copian.
+// Los sonidos en streaming se quedan a su frecuencia original.
+// Se comparte entre instancias a través de SampleCache, por eso lleva cuenta de referencias;
+// las referencias nunca se sueltan en el hilo de audio.
+class DualLayerSampleData : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<DualLayerSampleData>;
+
+    static constexpr int numLanes = 4;
+    static constexpr int paddingFrames = 8; // silencio antes y después para los taps del interpolador
+    static constexpr double maxResidentSeconds = 30.0;
+    static constexpr double streamHeadSeconds = 1.0;
+
+    DualLayerSampleData(const juce::String& soundName,
+                        juce::AudioFormatReader& cleanSource,
+                        juce::AudioFormatReader& excitedSource,
+                        DualLayerReaderFactory streamFactory = {},
+                        double targetSampleRate = 0.0);
+
+    // true si el sonido de estos lectores se carga entero en memoria (y no en streaming)
+    static bool isResident(const juce::AudioFormatReader& cleanSource, const juce::AudioFormatReader& excitedSource);
+
+    const juce::String& getName() const noexcept { return name; }
+
+    // Frames entrelazados de la cabeza, con paddingFrames de silencio antes del primero y después
+    // del último. Si el sonido no está en streaming la cabeza es el sonido entero.
+    const float* getFrameData() const noexcept { return frames; }
+    int getHeadLength() const noexcept { return headLength; }
+    int getLength() const noexcept { return length; }
+    double getSourceSampleRate() const noexcept { return sourceSampleRate; }
+    size_t getSizeInBytes() const noexcept { return (size_t) (headLength + 2 * paddingFrames) * numLanes * sizeof(float); }
+
+    bool isStreamed() const noexcept { return headLength < length; }
+    DualLayerReaderPair openStreamReaders() const { return streamReaders != nullptr ? streamReaders() : DualLayerReaderPair(); }
+
+private:
+    void allocateFrames(int numFrames);
+    void resampleTo(double targetSampleRate);
+
+    juce::String name;
+    juce::HeapBlock<float> frameStorage;
+    float* frames { nullptr };
+    int headLength { 0 };
+    int length { 0 };
+    double sourceSampleRate { 0.0 };
+    DualLayerReaderFactory streamReaders;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DualLayerSampleData)
+};
+
+// Sonido fijo de cada DualLayerSynthesiser: nunca se quita del Synthesiser, sólo cambian
+// los datos que reproduce. El cargador publica datos nuevos con un intercambio atómico y
+// el hilo de audio los adopta al principio del bloque, sin locks ni clearSounds().
+// Los datos antiguos se retiran cuando la última voz que los usaba termina y su referencia
+// se suelta fuera del hilo de audio en collectGarbage().
+// Las voces activas se cuentan aquí y no en los datos, que pueden estar sonando a la vez
+// en otra instancia con otro hilo de audio.
+class DualLayerSound : public juce::SynthesiserSound
+{
+public:
+    DualLayerSound(const juce::BigInteger& notes, int midiNoteForNormalPitch);
+    ~DualLayerSound() override;
+
+    // Hilo del cargador
+    void publish(DualLayerSampleData::Ptr newData);
+    void collectGarbage();
+
+    // Hilo de audio
+    void updateCurrentData();
+    DualLayerSampleData* getCurrentData() const noexcept { return current.data; }
+    void voiceStarted(DualLayerSampleData& data) noexcept;
+    void voiceStopped(DualLayerSampleData& data) noexcept;
+
+    int getMidiRootNote() const noexcept { return midiRootNote; }
+
+    void setEnvelopeParameters(const juce::ADSR::Parameters& parametersToUse) { params = parametersToUse; }
+    const juce::ADSR::Parameters& getEnvelopeParameters() const noexcept { return params; }
+
+    bool appliesToNote(int midiNoteNumber) override { return midiNotes[midiNoteNumber]; }
+    bool appliesToChannel(int midiChannel) override { return true; }
+
+private:
+    static constexpr int maxRetiring = 8;
+    static constexpr int retiredCapacity = 32;
+
+    // Cada slot tiene una referencia a sus datos
+    struct DataSlot
+    {
+        DualLayerSampleData* data = nullptr;
+        int activeVoices = 0;
+    };
+
+    void retireUnusedData();
+    bool retire(DualLayerSampleData* data) noexcept;
+    DataSlot* findSlot(DualLayerSampleData& data) noexcept;
+
+    std::atomic<DualLayerSampleData*> pending { nullptr };
+    DataSlot current;
+
+    // Datos sustituidos que todavía tienen voces sonando (sólo hilo de audio)
+    std::array<DataSlot, maxRetiring> retiring {};
+
+    // Referencias que ya no se usan: el hilo de audio escribe y el cargador las suelta
+    juce::AbstractFifo retiredFifo { retiredCapacity };
+    std::array<DualLayerSampleData*, retiredCapacity> retired {};
+
+    juce::BigInteger midiNotes;
+    int midiRootNote { 60 };
+    juce::ADSR::Parameters params;
+
+    JUCE_LEAK_DETECTOR(DualLayerSound)
+};
+
+// Estado de las voces de un DualLayerSynthesiser en estructura de arrays, un índice por voz.
+// Cada voz lo copia a variables locales al empezar su bloque y lo devuelve al terminarlo; las
+// pasadas que recorren todas las voces (robo de voces, modulación del filtro, telemetría) leen
+// arrays contiguos en vez de saltar de objeto en objeto. Sólo lo toca el hilo de audio.
+struct VoiceStateTable
+{
+    void resize(int numVoices);
+    int size() const noexcept { return (int) noteOnOrder.size(); }
+    juce::uint32 nextNoteOnOrder() noexcept { return ++noteOnCounter; }
+
+    std::vector<double> position;            // frame de lectura del sonido
+    std::vector<double> increment;           // frames del sonido por sample de salida
+    std::vector<float> envelope;             // último valor de la envolvente
+    std::vector<float> gain;                 // velocity de la nota
+    std::vector<juce::uint32> noteOnOrder;   // orden de inicio de la nota; 0 = voz libre
+    std::vector<juce::uint8> releasing;
+
+private:
+    juce::uint32 noteOnCounter { 0 };
+};
+
+// Voz que reproduce clean y excited a la vez, con la misma posición de lectura,
+// y aplica el crossfade de MixAmount dentro del bucle interno.
+// El loop es por voz: la posición salta de loopEnd a loopStart en el sample exacto,
+// sin reiniciar la envolvente, y opcionalmente funde la costura con un crossfade.
+// Con datos en streaming la voz lee la cabeza y después su VoiceStream, donde la posición
+// es lógica (no da la vuelta) y el loop queda fijado al empezar la nota.
+class DualLayerVoice : public juce::SynthesiserVoice
+{
+public:
+    DualLayerVoice(const DualLayerRenderState& state, SampleStreamer& streamer, VoiceStateTable& table, int slot);
+    ~DualLayerVoice() override;
+
+    bool canPlaySound(juce::SynthesiserSound* sound) override;
+
+    void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound* sound, int pitchWheel) override;
+    void stopNote(float velocity, bool allowTailOff) override;
+
+    void pitchWheelMoved(int newValue) override {}
+    void controllerMoved(int controllerNumber, int newValue) override {}
+
+    void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
+    using juce::SynthesiserVoice::renderNextBlock;
+
+    // Hilo de audio, al final del bloque
+    VoiceTelemetry getTelemetry() const noexcept;
+
+    // Hilo de audio: false si la voz lee de su stream y le faltan frames para los próximos numSamples
+    bool isStreamBuffered(int numSamples) const noexcept;
+
+    // Modulación del filtro: el sintetizador lee envolvente y velocity en la tabla y devuelve los coeficientes
+    void setFilterTarget(const VoiceFilter::Coefficients& target, int numSamples) noexcept { filter.setTarget(target, numSamples); }
+    void resetFilter() noexcept { filter.reset(); }
+
+private:
+    void finishNote();
+    void renderResident(float* outL, float* outR, int numSamples, const float* cleanRamp, const float* excitedRamp);
+    void renderStreamed(float* outL, float* outR, int numSamples, const float* cleanRamp, const float* excitedRamp);
+    const float* getStreamedFrames(juce::int64 logicalFrame) noexcept;
+
+    const DualLayerRenderState& renderState;
+    DualLayerSampleData* playingData { nullptr };
+
+    SampleStreamer& sampleStreamer;
+    VoiceStream stream;
+    bool streaming { false };
+    juce::int64 headLimit { 0 }; // frames lógicos que se leen de la cabeza
+    StreamLoop streamLoop;
+
+    // Taps que cruzan de la cabeza al ring se copian aquí para que sean contiguos
+    static constexpr int maxTaps = SampleInterpolator::maxFramesBefore + SampleInterpolator::maxFramesAfter + 1;
+    alignas(16) float tapScratch[maxTaps * DualLayerSampleData::numLanes] {};
+
+    SampleInterpolator interpolator;
+
+    // Posición, incremento, envolvente y ganancia viven en la tabla del sintetizador
+    VoiceStateTable& voiceState;
+    const size_t slot;
+
+    juce::ADSR adsr;
+    VoiceFilter filter;
+
+    // juce::ADSR no expone su etapa: se deduce del tiempo desde noteOn con los parámetros de la nota
+    juce::ADSR::Parameters envelopeParameters;
+    juce::int64 samplesSinceNoteOn { 0 };
+
+    JUCE_LEAK_DETECTOR(DualLayerVoice)
+};
+
+// Synthesiser con voces DualLayerVoice; sustituye a la pareja de samplers clean/excited.
+// Las voces se crean todas en el constructor y la polifonía sólo limita cuántas se asignan,
+// así se puede cambiar desde el hilo de audio sin reservar memoria. Sin voces libres se roba
+// según StealingPolicy, buscando en la tabla de estado de las voces.
+// Con el filtro activo el render se parte en tramos de filterControlInterval samples: al
+// principio de cada uno se calcula el corte de todas las voces de una pasada (base suavizada
+// más envolvente y velocity en octavas) y cada voz interpola sus coeficientes hasta el siguiente.
+class DualLayerSynthesiser : public juce::Synthesiser
+{
+public:
+    static constexpr int filterControlInterval = 32;
+
+    // Mismo orden que el parámetro VoiceStealing
+    enum class StealingPolicy
+    {
+        oldest,     // la que empezó antes, primero entre las que están en release
+        quietest,   // la de menor nivel (envolvente por velocity)
+        sameNote    // con el pool lleno, la que ya toca la misma nota; si no hay, la más antigua
+    };
+
+    DualLayerSynthesiser(int maxVoices, SampleStreamer& streamer);
+    ~DualLayerSynthesiser() override;
+
+    // Ganancias de la mezcla para el siguiente tramo; la rampa tiene que seguir viva mientras se renderiza
+    void setMixGains(float cleanGain, float excitedGain) noexcept;
+    void setInterpolationMode(SampleInterpolator::Mode mode) noexcept { renderState.interpolationMode = mode; }
+    void setMixGainRamp(const float* cleanGains, const float* excitedGains, int firstSample) noexcept;
+    void setLoop(bool enabled, double startSeconds, double endSeconds, double crossfadeSeconds) noexcept;
+    void setEnvelopeParameters(const juce::ADSR::Parameters& parametersToUse);
+
+    // Hilo de audio; las voces por encima del límite terminan su nota pero no se vuelven a asignar
+    void setPolyphony(int numVoices) noexcept { polyphony = juce::jlimit(1, voiceState.size(), numVoices); }
+    void setStealingPolicy(StealingPolicy newPolicy) noexcept { stealingPolicy = newPolicy; }
+
+    // Corte en Hz; las modulaciones en octavas por unidad de envolvente y de velocity
+    void setFilter(bool enabled, VoiceFilter::Type type, float cutoffHz, float resonance,
+                   float envelopeOctaves, float velocityOctaves) noexcept;
+
+    void setCurrentPlaybackSampleRate(double newRate) override;
+
+    // Ver DualLayerSound: publish/collectGarbage desde el cargador, updateSampleData desde el audio
+    void publishSampleData(DualLayerSampleData::Ptr newData) { sound->publish(std::move(newData)); }
+    void collectGarbage() { sound->collectGarbage(); }
+    void updateSampleData() { sound->updateCurrentData(); }
+
+    // Hilo de audio: añade a frame el estado de las voces que suenan
+    void fillTelemetry(TelemetryFrame& frame, int layer) const noexcept;
+
+    // Hilo de audio: true si ninguna voz en streaming se quedaría sin frames en los próximos numSamples
+    bool isStreamBuffered(int numSamples) const noexcept;
+
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    // Ciclos gastados en eventos MIDI desde la llamada anterior (el hilo que haya renderizado)
+    juce::uint64 takeMidiCycles() noexcept { return std::exchange(midiCycles, (juce::uint64) 0); }
+   #endif
+
+protected:
+    void renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    void handleMidiEvent(const juce::MidiMessage& message) override;
+   #endif
+
+    juce::SynthesiserVoice* findFreeVoice(juce::SynthesiserSound* soundToPlay, int midiChannel,
+                                          int midiNoteNumber, bool stealIfNoneAvailable) const override;
+    juce::SynthesiserVoice* findVoiceToSteal(juce::SynthesiserSound* soundToPlay, int midiChannel,
+                                             int midiNoteNumber) const override;
+
+private:
+    void updateFilterCoefficients(int numSamples) noexcept;
+    int findOldestVoice() const noexcept;
+    int findQuietestVoice() const noexcept;
+
+    DualLayerRenderState renderState;
+    DualLayerSound* sound { nullptr };
+
+    VoiceStateTable voiceState;
+    int polyphony { 0 };
+    StealingPolicy stealingPolicy { StealingPolicy::oldest };
+
+    // El corte se suaviza en log2(Hz) para que la rampa suene igual en todo el rango
+    SmoothedParameter cutoffSmoother;
+    float filterResonance { 0.7f };
+    float filterEnvelopeOctaves { 0.0f };
+    float filterVelocityOctaves { 0.0f };
+
+    // Espacio por voz para la actualización conjunta de coeficientes (reservado en el constructor)
+    std::vector<float> filterCutoffs;
+    std::vector<VoiceFilter::Coefficients> filterCoefficients;
+
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    juce::uint64 midiCycles { 0 };
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DualLayerSynthesiser)
+};
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    InterpolatorBenchmark.cpp
+    Created: 18 Oct 2026 3:52:19am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+// Herramienta de consola aparte (no entra en el plugin): mide cuántas voces caben en un núcleo
+// con cada modo de SampleInterpolator, para elegir la calidad de cada proyecto. Se compila con
+// Tools/CMakeLists.txt (ver Tools/README.md).
+//
+//   InterpolatorBenchmark [--seconds <s>] [--sample-rate <hz>] [--ratio <r>]...
+
+#include "JuceHeader.h"
+#include <iostream>
+#include "SampleInterpolator.h"
+
+namespace
+{
+    constexpr int numLanes = SampleInterpolator::numLanes;
+    constexpr int padding = 8;
+
+    struct BenchmarkResult
+    {
+        double seconds = 0.0;
+        double voicesPerCore = 0.0;
+        float checksum = 0.0f;
+    };
+
+    // Mismo bucle interno que DualLayerVoice::renderResident sin loop: interpolar, aplicar la
+    // envolvente y sumar a la salida
+    BenchmarkResult runVoice(SampleInterpolator::Mode mode, double pitchRatio, const float* frames, int length,
+                             int numOutputSamples, double sampleRate)
+    {
+        SampleInterpolator interpolator;
+        interpolator.prepare(mode, pitchRatio);
+
+        juce::AudioBuffer<float> output(2, 512);
+        alignas(16) const float laneGains[numLanes] = { 0.7f, 0.7f, 0.7f, 0.7f };
+        alignas(16) float mixed[numLanes];
+
+        double position = 0.0;
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int rendered = 0; rendered < numOutputSamples; rendered += output.getNumSamples())
+        {
+            const auto blockSize = juce::jmin(output.getNumSamples(), numOutputSamples - rendered);
+            float* outL = output.getWritePointer(0);
+            float* outR = output.getWritePointer(1);
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto pos = (int) position;
+                interpolator.process(frames + (size_t) pos * numLanes, (float) (position - pos), laneGains, mixed);
+
+                outL[i] += mixed[0] + mixed[1];
+                outR[i] += mixed[2] + mixed[3];
+
+                position += pitchRatio;
+
+                // Vuelta al principio para poder medir cualquier duración con el mismo sonido
+                if (position >= length)
+                    position -= length;
+            }
+        }
+
+        BenchmarkResult result;
+        result.seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        result.voicesPerCore = result.seconds > 0.0 ? (numOutputSamples / sampleRate) / result.seconds : 0.0;
+        result.checksum = output.getSample(0, 0) + output.getSample(1, output.getNumSamples() - 1);
+        return result;
+    }
+
+    const char* getModeName(SampleInterpolator::Mode mode)
+    {
+        switch (mode)
+        {
+            case SampleInterpolator::Mode::hermite: return "hermite";
+            case SampleInterpolator::Mode::sinc:    return "sinc";
+            case SampleInterpolator::Mode::linear:
+            default:                                return "linear";
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = 10.0;
+    double sampleRate = 48000.0;
+    juce::Array<double> ratios;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+
+        if (arg == "--seconds" && i + 1 < argc)
+            seconds = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--sample-rate" && i + 1 < argc)
+            sampleRate = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--ratio" && i + 1 < argc)
+            ratios.add(juce::String(argv[++i]).getDoubleValue());
+        else
+        {
+            std::cout << "Usage: InterpolatorBenchmark [--seconds <s>] [--sample-rate <hz>] [--ratio <r>]..." << std::endl;
+            return 1;
+        }
+    }
+
+    if (ratios.isEmpty())
+        ratios = { 0.5, 1.0, 1.5, 2.0, 4.0 };
+
+    // Diez segundos de ruido entrelazado con el mismo relleno que DualLayerSampleData
+    const auto length = (int) (10.0 * sampleRate);
+    juce::HeapBlock<float> storage((size_t) (length + 2 * padding) * numLanes + numLanes, true);
+    auto* frames = juce::dsp::SIMDRegister<float>::getNextSIMDAlignedPtr(storage.get()) + padding * numLanes;
+
+    juce::Random random(1234);
+
+    for (int i = 0; i < length * numLanes; ++i)
+        frames[i] = random.nextFloat() * 2.0f - 1.0f;
+
+    const auto numOutputSamples = (int) (seconds * sampleRate);
+    const SampleInterpolator::Mode modes[] = { SampleInterpolator::Mode::linear,
+                                               SampleInterpolator::Mode::hermite,
+                                               SampleInterpolator::Mode::sinc };
+
+    std::cout << "mode      ratio   ns/sample   voices/core" << std::endl;
+
+    float checksum = 0.0f;
+
+    for (auto mode : modes)
+    {
+        for (auto ratio : ratios)
+        {
+            const auto result = runVoice(mode, ratio, frames, length, numOutputSamples, sampleRate);
+            checksum += result.checksum;
+
+            std::cout << juce::String(getModeName(mode)).paddedRight(' ', 10)
+                      << juce::String(ratio, 2).paddedRight(' ', 8)
+                      << juce::String(result.seconds * 1.0e9 / numOutputSamples, 2).paddedRight(' ', 12)
+                      << juce::String(result.voicesPerCore, 0) << std::endl;
+        }
+    }
+
+    // Para que el compilador no elimine el render
+    std::cout << "checksum " << checksum << std::endl;
+    return 0;
+}
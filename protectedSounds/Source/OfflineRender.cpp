@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+    OfflineRender.cpp
+    Created: 18 Oct 2026 5:37:02pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+// Herramienta de consola aparte: se compila con las fuentes del plugin (sin el wrapper de
+// ningún formato) y renderiza ficheros MIDI con ProtectedSoundsAudioProcessor, tan rápido como
+// deje la CPU. Sirve para bounces por lotes y como carga reproducible para medir.
+// Se compila con Tools/CMakeLists.txt (ver Tools/README.md).
+//
+//   OfflineRender [opciones] <sonido> <entrada.mid>...
+//
+//   --sound2 <nombre>       sonido del selector 2 (por defecto el mismo)
+//   --sample-rate <hz>      48000
+//   --block-size <n>        512
+//   --tail <s>              segundos que se siguen renderizando después del último evento (2)
+//   --jobs <n>              ficheros en paralelo, cada uno con su instancia (1)
+//   --output-dir <dir>      dónde se escriben los WAV (por defecto junto a cada .mid)
+//   --param <id>=<valor>    valor de un parámetro en sus unidades, p. ej. MixAmount=30
+
+#include "JuceHeader.h"
+#include <iostream>
+#include <thread>
+#include "PluginProcessor.h"
+
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace
+{
+    constexpr int loadTimeoutMs = 60000;
+
+    struct RenderOptions
+    {
+        juce::String sound1;
+        juce::String sound2;
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        double tailSeconds = 2.0;
+        juce::File outputDir;
+        juce::StringPairArray parameterValues;
+    };
+
+    struct RenderResult
+    {
+        bool ok = false;
+        juce::String error;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: OfflineRender [options] <sound> <input.mid>..." << std::endl
+                  << "Options: --sound2 <name>  --sample-rate <hz>  --block-size <n>  --tail <s>" << std::endl
+                  << "         --jobs <n>  --output-dir <dir>  --param <id>=<value>" << std::endl;
+    }
+
+    // Todas las pistas en una sola secuencia con los tiempos en segundos
+    bool readMidiFile(const juce::File& file, juce::MidiMessageSequence& sequence)
+    {
+        juce::FileInputStream stream(file);
+        juce::MidiFile midiFile;
+
+        if (! stream.openedOk() || ! midiFile.readFrom(stream))
+            return false;
+
+        midiFile.convertTimestampTicksToSeconds();
+
+        for (int track = 0; track < midiFile.getNumTracks(); ++track)
+            sequence.addSequence(*midiFile.getTrack(track), 0.0);
+
+        sequence.updateMatchedPairs();
+        return true;
+    }
+
+    // Una instancia por hilo de render; se crea y se prepara en el hilo principal
+    std::unique_ptr<ProtectedSoundsAudioProcessor> createProcessor(const RenderOptions& options, juce::String& error)
+    {
+        std::unique_ptr<juce::AudioProcessor> base(createPluginFilter());
+        std::unique_ptr<ProtectedSoundsAudioProcessor> processor(dynamic_cast<ProtectedSoundsAudioProcessor*>(base.get()));
+
+        if (processor == nullptr)
+        {
+            error = "createPluginFilter() did not return a ProtectedSoundsAudioProcessor";
+            return nullptr;
+        }
+
+        base.release();
+
+        processor->setNonRealtime(true);
+        processor->setPlayConfigDetails(0, 2, options.sampleRate, options.blockSize);
+        processor->prepareToPlay(options.sampleRate, options.blockSize);
+
+        for (const auto& parameterID : options.parameterValues.getAllKeys())
+        {
+            auto* parameter = processor->getAPVTS().getParameter(parameterID);
+
+            if (parameter == nullptr)
+            {
+                error = "unknown parameter " + parameterID;
+                return nullptr;
+            }
+
+            const auto value = options.parameterValues[parameterID].getFloatValue();
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+
+        // Aquí no se despachan mensajes: el pool de ParallelLayers se crea a mano
+        processor->updateRenderPool();
+
+        // Con la frecuencia ya fijada, para que los sonidos se carguen convertidos a ella
+        processor->loadSoundPairForSelector1(options.sound1);
+        processor->loadSoundPairForSelector2(options.sound2);
+
+        if (! processor->waitForSoundLoads(loadTimeoutMs))
+        {
+            error = "timed out loading " + options.sound1;
+            return nullptr;
+        }
+
+        return processor;
+    }
+
+    RenderResult renderFile(ProtectedSoundsAudioProcessor& processor, const RenderOptions& options,
+                            const juce::File& input, const juce::File& output)
+    {
+        RenderResult result;
+        juce::MidiMessageSequence sequence;
+
+        if (! readMidiFile(input, sequence))
+        {
+            result.error = "cannot read " + input.getFullPathName();
+            return result;
+        }
+
+        output.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(output);
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (stream->openedOk())
+            writer.reset(wav.createWriterFor(stream.get(), options.sampleRate, 2, 24, {}, 0));
+
+        if (writer == nullptr)
+        {
+            result.error = "cannot write " + output.getFullPathName();
+            return result;
+        }
+
+        stream.release(); // ahora es del writer
+
+        const auto sampleRate = options.sampleRate;
+        const auto totalSamples = (juce::int64) std::ceil((sequence.getEndTime() + options.tailSeconds) * sampleRate);
+
+        juce::AudioBuffer<float> buffer(2, options.blockSize);
+        juce::MidiBuffer midi;
+        int nextEvent = 0;
+
+        processor.reset();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (juce::int64 position = 0; position < totalSamples; position += options.blockSize)
+        {
+            const auto numSamples = (int) juce::jmin((juce::int64) options.blockSize, totalSamples - position);
+            const auto blockEnd = position + numSamples;
+
+            midi.clear();
+
+            for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+            {
+                const auto& message = sequence.getEventPointer(nextEvent)->message;
+                const auto eventSample = (juce::int64) std::llround(message.getTimeStamp() * sampleRate);
+
+                if (eventSample >= blockEnd)
+                    break;
+
+                if (! message.isMetaEvent())
+                    midi.addEvent(message, (int) juce::jmax((juce::int64) 0, eventSample - position));
+            }
+
+            buffer.setSize(2, numSamples, false, false, true);
+            processor.processBlock(buffer, midi);
+            writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+        }
+
+        result.renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        result.audioSeconds = (double) totalSamples / sampleRate;
+        result.ok = true;
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // El procesador usa MessageManager (callAsync, timers de APVTS) aunque aquí nadie lo despache
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderOptions options;
+    int numJobs = 1;
+    juce::StringArray arguments;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+
+        if (arg == "--sound2" && i + 1 < argc)
+            options.sound2 = argv[++i];
+        else if (arg == "--sample-rate" && i + 1 < argc)
+            options.sampleRate = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--block-size" && i + 1 < argc)
+            options.blockSize = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--tail" && i + 1 < argc)
+            options.tailSeconds = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--jobs" && i + 1 < argc)
+            numJobs = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--output-dir" && i + 1 < argc)
+            options.outputDir = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else if (arg == "--param" && i + 1 < argc)
+        {
+            const juce::String assignment(argv[++i]);
+            options.parameterValues.set(assignment.upToFirstOccurrenceOf("=", false, false),
+                                        assignment.fromFirstOccurrenceOf("=", false, false));
+        }
+        else
+            arguments.add(arg);
+    }
+
+    if (arguments.size() < 2 || options.sampleRate <= 0.0 || options.blockSize <= 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    options.sound1 = arguments[0];
+
+    if (options.sound2.isEmpty())
+        options.sound2 = options.sound1;
+
+    juce::Array<juce::File> inputs;
+
+    for (int i = 1; i < arguments.size(); ++i)
+        inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arguments[i]));
+
+    if (options.outputDir != juce::File())
+        options.outputDir.createDirectory();
+
+    numJobs = juce::jlimit(1, inputs.size(), numJobs);
+
+    // Las instancias se crean aquí; los hilos sólo renderizan
+    std::vector<std::unique_ptr<ProtectedSoundsAudioProcessor>> processors;
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        juce::String error;
+        auto processor = createProcessor(options, error);
+
+        if (processor == nullptr)
+        {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+
+        processors.push_back(std::move(processor));
+    }
+
+    std::vector<RenderResult> results((size_t) inputs.size());
+    std::atomic<int> nextInput { 0 };
+    std::vector<std::thread> threads;
+
+    const auto start = juce::Time::getHighResolutionTicks();
+
+    for (int job = 0; job < numJobs; ++job)
+    {
+        threads.emplace_back([&, job]
+        {
+            for (int index = nextInput++; index < inputs.size(); index = nextInput++)
+            {
+                const auto& input = inputs.getReference(index);
+                const auto dir = options.outputDir != juce::File() ? options.outputDir : input.getParentDirectory();
+                const auto output = dir.getChildFile(input.getFileNameWithoutExtension() + ".wav");
+
+                results[(size_t) index] = renderFile(*processors[(size_t) job], options, input, output);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    const auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+    std::cout << "file                            audio (s)   render (s)   realtime x" << std::endl;
+
+    double totalAudioSeconds = 0.0;
+    int failures = 0;
+
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        const auto& result = results[(size_t) i];
+
+        if (! result.ok)
+        {
+            std::cerr << "Error: " << result.error << std::endl;
+            ++failures;
+            continue;
+        }
+
+        totalAudioSeconds += result.audioSeconds;
+
+        std::cout << inputs[i].getFileName().paddedRight(' ', 32)
+                  << juce::String(result.audioSeconds, 2).paddedRight(' ', 12)
+                  << juce::String(result.renderSeconds, 3).paddedRight(' ', 13)
+                  << juce::String(result.renderSeconds > 0.0 ? result.audioSeconds / result.renderSeconds : 0.0, 1)
+                  << std::endl;
+    }
+
+    // Con varios jobs el total cuenta el tiempo de reloj de todo el lote
+    std::cout << "total " << juce::String(totalAudioSeconds, 2) << " s of audio in "
+              << juce::String(wallSeconds, 3) << " s: "
+              << juce::String(wallSeconds > 0.0 ? totalAudioSeconds / wallSeconds : 0.0, 1) << "x realtime"
+              << " (" << numJobs << " job" << (numJobs == 1 ? "" : "s") << ")" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    ParameterSmoothing.cpp
+    Created: 18 Oct 2026 1:21:37am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "ParameterSmoothing.h"
+
+// ============================================================================
+// SmoothedParameter
+// ============================================================================
+
+void SmoothedParameter::reset(double sampleRate, double rampSeconds, float initialValue) noexcept
+{
+    rampLength = juce::jmax(0, juce::roundToInt(sampleRate * rampSeconds));
+    current = target = initialValue;
+    step = 0.0f;
+    countdown = 0;
+}
+
+void SmoothedParameter::setTargetValue(float newTarget) noexcept
+{
+    if (newTarget == target)
+        return;
+
+    target = newTarget;
+
+    if (rampLength <= 0)
+    {
+        current = target;
+        countdown = 0;
+        return;
+    }
+
+    // Un cambio a mitad de rampa arranca otra desde el valor actual
+    countdown = rampLength;
+    step = (target - current) / (float) countdown;
+}
+
+void SmoothedParameter::fillRamp(float* dest, int numSamples) noexcept
+{
+    const auto rampSamples = juce::jmin(numSamples, countdown);
+
+    // Sin dependencias entre samples: el compilador lo vectoriza
+    const auto start = current;
+
+    for (int i = 0; i < rampSamples; ++i)
+        dest[i] = start + step * (float) (i + 1);
+
+    countdown -= rampSamples;
+    current = countdown > 0 ? start + step * (float) rampSamples : target;
+
+    if (rampSamples < numSamples)
+        juce::FloatVectorOperations::fill(dest + rampSamples, target, numSamples - rampSamples);
+}
+
+float SmoothedParameter::skip(int numSamples) noexcept
+{
+    const auto rampSamples = juce::jmin(numSamples, countdown);
+
+    countdown -= rampSamples;
+    current = countdown > 0 ? current + step * (float) rampSamples : target;
+    return current;
+}
+
+// ============================================================================
+// EqualPowerCrossfade
+// ============================================================================
+
+namespace
+{
+    // cos(x * pi/2) para x en 0..1, con un punto extra para interpolar en x = 1
+    struct EqualPowerTable
+    {
+        static constexpr int size = 1024;
+
+        EqualPowerTable()
+        {
+            for (int i = 0; i <= size; ++i)
+                values[(size_t) i] = std::cos((float) i / (float) size * juce::MathConstants<float>::halfPi);
+
+            values[(size_t) size + 1] = 0.0f;
+        }
+
+        float lookup(float x) const noexcept
+        {
+            const auto position = juce::jlimit(0.0f, 1.0f, x) * (float) size;
+            const auto index = (int) position;
+            const auto alpha = position - (float) index;
+            return values[(size_t) index] + (values[(size_t) index + 1] - values[(size_t) index]) * alpha;
+        }
+
+        std::array<float, size + 2> values {};
+    };
+
+    // Se construye al cargar el plugin, nunca por primera vez en el hilo de audio
+    const EqualPowerTable equalPowerTable;
+}
+
+void EqualPowerCrossfade::getGains(float mix, float& cleanGain, float& excitedGain) noexcept
+{
+    cleanGain = equalPowerTable.lookup(mix);
+    excitedGain = equalPowerTable.lookup(1.0f - mix);
+}
+
+void EqualPowerCrossfade::fillGains(const float* mix, float* cleanGains, float* excitedGains, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        cleanGains[i] = equalPowerTable.lookup(mix[i]);
+        excitedGains[i] = equalPowerTable.lookup(1.0f - mix[i]);
+    }
+}
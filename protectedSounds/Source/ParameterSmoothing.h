@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    ParameterSmoothing.h
+    Created: 18 Oct 2026 1:21:37am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Rampa lineal de un parámetro hacia el último valor que ha mandado el host.
+// A diferencia de juce::SmoothedValue expone cuántos samples faltan para llegar, para que
+// processBlock pueda partir el bloque justo donde termina la rampa y volver al camino constante.
+class SmoothedParameter
+{
+public:
+    SmoothedParameter() = default;
+
+    void reset(double sampleRate, double rampSeconds, float initialValue) noexcept;
+    void setTargetValue(float newTarget) noexcept;
+
+    bool isSmoothing() const noexcept { return countdown > 0; }
+    int getSamplesToTarget() const noexcept { return countdown; }
+    float getCurrentValue() const noexcept { return current; }
+    float getTargetValue() const noexcept { return target; }
+
+    // Escribe los siguientes numSamples valores y avanza; pasado el objetivo se rellena con él
+    void fillRamp(float* dest, int numSamples) noexcept;
+
+    // Avanza numSamples sin escribir la rampa y devuelve el valor alcanzado
+    float skip(int numSamples) noexcept;
+
+private:
+    float current { 0.0f };
+    float target { 0.0f };
+    float step { 0.0f };
+    int countdown { 0 };
+    int rampLength { 0 };
+
+    JUCE_LEAK_DETECTOR(SmoothedParameter)
+};
+
+// Crossfade de potencia constante (cos/sin) sacado de una tabla precalculada: el nivel no
+// baja 3 dB en el centro como con el fundido lineal y no hay trigonometría en el hilo de audio.
+namespace EqualPowerCrossfade
+{
+    // mix en 0..1 (0 = todo clean, 1 = todo excited)
+    void getGains(float mix, float& cleanGain, float& excitedGain) noexcept;
+    void fillGains(const float* mix, float* cleanGains, float* excitedGains, int numSamples) noexcept;
+}
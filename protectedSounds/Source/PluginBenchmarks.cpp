@@ -0,0 +1,470 @@
+/*
+  ==============================================================================
+
+    PluginBenchmarks.cpp
+    Created: 18 Oct 2026 6:44:51pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+// Herramienta de consola aparte, como OfflineRender: se compila con las fuentes del plugin y
+// mide sus caminos críticos. El resultado sale en JSON para guardarlo con cada versión y
+// comparar entre releases. Se compila con Tools/CMakeLists.txt (ver Tools/README.md).
+//
+//   PluginBenchmarks [--sound <nombre>] [--seconds <s>] [--only <prefijo>] [--output <fichero.json>]
+//
+//   processBlock   bloques de 16 a 4096 samples, 1/8/32 notas, loop apagado y encendido; y en
+//                  64/256/1024 samples con 8 y 32 notas, el filtro, las capas en paralelo y
+//                  cada modo de interpolación (lo demás con los valores por defecto)
+//   decrypt        ProtectedSoundsManager::loadSoundEncrypted leído entero (MB/s)
+//   load           loadSoundPairForSelector1 hasta que el cargador termina (en frío y en caché)
+//   waveform       decimación de WaveformPeaks por píxel y paint de WaveformDisplay
+
+#include "JuceHeader.h"
+#include <iostream>
+#include "PluginProcessor.h"
+#include "WaveformDisplay.h"
+
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int loadTimeoutMs = 60000;
+
+    struct BenchmarkOptions
+    {
+        juce::String sound;
+        double seconds = 2.0;
+        juce::String only;
+    };
+
+    // Media, mediana, percentil 99 y máximo de una serie de tiempos en segundos
+    juce::var describeTimes(std::vector<double> times)
+    {
+        auto* stats = new juce::DynamicObject();
+
+        if (times.empty())
+            return juce::var(stats);
+
+        std::sort(times.begin(), times.end());
+
+        double total = 0.0;
+
+        for (auto t : times)
+            total += t;
+
+        const auto percentile = [&times](double p) { return times[(size_t) ((double) (times.size() - 1) * p)]; };
+
+        stats->setProperty("meanUs", total / (double) times.size() * 1.0e6);
+        stats->setProperty("medianUs", percentile(0.5) * 1.0e6);
+        stats->setProperty("p99Us", percentile(0.99) * 1.0e6);
+        stats->setProperty("maxUs", times.back() * 1.0e6);
+        return juce::var(stats);
+    }
+
+    double secondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    }
+
+    std::unique_ptr<ProtectedSoundsAudioProcessor> createProcessor(int blockSize)
+    {
+        std::unique_ptr<juce::AudioProcessor> base(createPluginFilter());
+        std::unique_ptr<ProtectedSoundsAudioProcessor> processor(dynamic_cast<ProtectedSoundsAudioProcessor*>(base.get()));
+
+        if (processor == nullptr)
+            return nullptr;
+
+        base.release();
+        processor->setPlayConfigDetails(0, 2, sampleRate, blockSize);
+        processor->prepareToPlay(sampleRate, blockSize);
+        return processor;
+    }
+
+    void setParameter(ProtectedSoundsAudioProcessor& processor, const char* parameterID, float value)
+    {
+        if (auto* parameter = processor.getAPVTS().getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // ========================================================================
+    // processBlock
+    // ========================================================================
+
+    // Un caso del barrido; interpolation es el índice del parámetro Interpolation
+    struct ProcessBlockCase
+    {
+        int blockSize = 512;
+        int numNotes = 8;
+        bool loop = false;
+        bool filter = false;
+        bool parallel = false;
+        int interpolation = 1;
+    };
+
+    const char* const interpolationNames[] = { "linear", "hermite", "sinc" };
+
+    // Las notas se vuelven a disparar cada retriggerSeconds para que sigan sonando con sonidos
+    // cortos y sin loop; así también entran en la medida la asignación y el arranque de voces
+    juce::var benchmarkProcessBlock(const BenchmarkOptions& options, const ProcessBlockCase& test)
+    {
+        constexpr double retriggerSeconds = 0.5;
+
+        const auto blockSize = test.blockSize;
+        const auto numNotes = test.numNotes;
+        auto processor = createProcessor(blockSize);
+
+        if (processor == nullptr)
+            return {};
+
+        setParameter(*processor, "Polyphony", (float) numNotes);
+        setParameter(*processor, "Sustain", 1.0f);
+        setParameter(*processor, "Sustain2", 1.0f);
+        setParameter(*processor, "FilterEnabled", test.filter ? 1.0f : 0.0f);
+        setParameter(*processor, "ParallelLayers", test.parallel ? 1.0f : 0.0f);
+        setParameter(*processor, "Interpolation", (float) test.interpolation);
+
+        // Aquí no se despachan mensajes: el pool de ParallelLayers se crea a mano
+        processor->updateRenderPool();
+
+        processor->loadSoundPairForSelector1(options.sound);
+        processor->loadSoundPairForSelector2(options.sound);
+        processor->waitForSoundLoads(loadTimeoutMs);
+        processor->setLoopEnabled(test.loop);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+
+        const auto numBlocks = juce::jmax(1, (int) (options.seconds * sampleRate / blockSize));
+        const auto retriggerBlocks = juce::jmax(1, (int) (retriggerSeconds * sampleRate / blockSize));
+
+        std::vector<double> blockTimes;
+        blockTimes.reserve((size_t) numBlocks);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            midi.clear();
+
+            if (block % retriggerBlocks == 0)
+            {
+                for (int i = 0; i < numNotes; ++i)
+                {
+                    const auto note = 36 + (i * 7) % 60;
+
+                    if (block > 0)
+                        midi.addEvent(juce::MidiMessage::noteOff(1, note), 0);
+
+                    midi.addEvent(juce::MidiMessage::noteOn(1, note, 0.8f), 0);
+                }
+            }
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor->processBlock(buffer, midi);
+            blockTimes.push_back(secondsSince(start));
+        }
+
+        double total = 0.0;
+
+        for (auto t : blockTimes)
+            total += t;
+
+        const auto deadline = blockSize / sampleRate;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", "processBlock");
+        result->setProperty("blockSize", blockSize);
+        result->setProperty("notes", numNotes);
+        result->setProperty("loop", test.loop);
+        result->setProperty("filter", test.filter);
+        result->setProperty("parallel", test.parallel);
+        result->setProperty("interpolation", juce::String(interpolationNames[test.interpolation]));
+        result->setProperty("nsPerSample", total / ((double) numBlocks * blockSize) * 1.0e9);
+        result->setProperty("deadlineUse", total / ((double) numBlocks * deadline));
+        result->setProperty("blocks", describeTimes(std::move(blockTimes)));
+        return juce::var(result);
+    }
+
+    // ========================================================================
+    // decrypt
+    // ========================================================================
+
+    juce::var benchmarkDecrypt(const juce::String& sound, int repetitions)
+    {
+        juce::SharedResourcePointer<ProtectedSoundsManager> manager;
+        const auto* info = manager->getSoundInfo(sound);
+
+        if (info == nullptr)
+            return {};
+
+        // Se mide la versión clean; la excited tiene el mismo formato
+        juce::HeapBlock<char> block(65536);
+        juce::int64 bytes = 0;
+        std::vector<double> times;
+
+        for (int i = 0; i < repetitions; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            bytes = 0;
+
+            if (auto stream = manager->loadSoundEncrypted(info->cleanResource))
+                for (int numRead; (numRead = stream->read(block.get(), 65536)) > 0;)
+                    bytes += numRead;
+
+            times.push_back(secondsSince(start));
+        }
+
+        double total = 0.0;
+
+        for (auto t : times)
+            total += t;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", "decrypt");
+        result->setProperty("sound", sound);
+        result->setProperty("bytes", bytes);
+        result->setProperty("mbPerSecond", total > 0.0 ? (double) bytes * repetitions / total / (1024.0 * 1024.0) : 0.0);
+        result->setProperty("reads", describeTimes(std::move(times)));
+        return juce::var(result);
+    }
+
+    // ========================================================================
+    // load
+    // ========================================================================
+
+    // La primera carga de un sonido en el proceso descifra y decodifica; las siguientes salen
+    // de SampleCache. Cada medida usa una instancia nueva, como al abrir el plugin otra vez
+    juce::var benchmarkLoad(const juce::String& sound, bool cold)
+    {
+        auto processor = createProcessor(512);
+
+        if (processor == nullptr)
+            return {};
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor->loadSoundPairForSelector1(sound);
+        const bool ok = processor->waitForSoundLoads(loadTimeoutMs);
+        const auto seconds = secondsSince(start);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", "load");
+        result->setProperty("sound", sound);
+        result->setProperty("cached", ! cold);
+        result->setProperty("ok", ok);
+        result->setProperty("ms", seconds * 1000.0);
+        return juce::var(result);
+    }
+
+    // ========================================================================
+    // waveform
+    // ========================================================================
+
+    std::shared_ptr<const WaveformPeaks> buildPeaks(const juce::String& sound)
+    {
+        juce::SharedResourcePointer<ProtectedSoundsManager> manager;
+        auto reader = manager->openReaderPair(sound).first;
+
+        if (reader == nullptr)
+            return nullptr;
+
+        auto peaks = std::make_shared<WaveformPeaks>(reader->lengthInSamples);
+        constexpr int blockSize = 65536;
+        juce::AudioBuffer<float> block(2, blockSize);
+
+        for (juce::int64 position = 0; position < reader->lengthInSamples; position += blockSize)
+        {
+            const auto numFrames = (int) juce::jmin((juce::int64) blockSize, reader->lengthInSamples - position);
+            reader->read(&block, 0, numFrames, position, true, true);
+            peaks->addFrames(block.getReadPointer(0), block.getReadPointer(1), numFrames);
+        }
+
+        peaks->finish();
+        return peaks;
+    }
+
+    // Decimación sola (un getPeak por píxel) y paint completo: en frío rehace la imagen de la
+    // forma de onda, en caliente sólo pinta las capas de encima
+    juce::var benchmarkWaveform(std::shared_ptr<const WaveformPeaks> peaks, int width, int height, int repetitions)
+    {
+        std::vector<double> decimationTimes, coldPaintTimes, warmPaintTimes;
+        float checksum = 0.0f;
+
+        for (int i = 0; i < repetitions; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            const auto numSamples = peaks->getNumSamples();
+
+            for (int x = 0; x < width; ++x)
+                checksum += peaks->getPeak(numSamples * x / width, numSamples * (x + 1) / width).getEnd();
+
+            decimationTimes.push_back(secondsSince(start));
+        }
+
+        WaveformDisplay display;
+        display.setSize(width, height);
+        display.setLoopRegion(true, 0.25, 0.75);
+
+        juce::Image image(juce::Image::ARGB, width, height, true);
+        juce::Graphics g(image);
+
+        for (int i = 0; i < repetitions; ++i)
+        {
+            display.setPeaks(nullptr);
+            display.setPeaks(peaks);
+
+            auto start = juce::Time::getHighResolutionTicks();
+            display.paintEntireComponent(g, false);
+            coldPaintTimes.push_back(secondsSince(start));
+
+            start = juce::Time::getHighResolutionTicks();
+            display.paintEntireComponent(g, false);
+            warmPaintTimes.push_back(secondsSince(start));
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", "waveform");
+        result->setProperty("width", width);
+        result->setProperty("height", height);
+        result->setProperty("samples", peaks->getNumSamples());
+        result->setProperty("decimation", describeTimes(std::move(decimationTimes)));
+        result->setProperty("coldPaint", describeTimes(std::move(coldPaintTimes)));
+        result->setProperty("warmPaint", describeTimes(std::move(warmPaintTimes)));
+        result->setProperty("checksum", checksum);
+        return juce::var(result);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Componentes, timers de APVTS y callAsync necesitan MessageManager aunque no se despache
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    BenchmarkOptions options;
+    juce::File outputFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+
+        if (arg == "--sound" && i + 1 < argc)
+            options.sound = argv[++i];
+        else if (arg == "--seconds" && i + 1 < argc)
+            options.seconds = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--only" && i + 1 < argc)
+            options.only = argv[++i];
+        else if (arg == "--output" && i + 1 < argc)
+            outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else
+        {
+            std::cout << "Usage: PluginBenchmarks [--sound <name>] [--seconds <s>] [--only <prefix>] [--output <file.json>]" << std::endl;
+            return 1;
+        }
+    }
+
+    juce::StringArray sounds;
+    {
+        juce::SharedResourcePointer<ProtectedSoundsManager> manager;
+        sounds = manager->getAvailableSounds();
+    }
+
+    if (sounds.isEmpty())
+    {
+        std::cerr << "Error: no sounds available" << std::endl;
+        return 1;
+    }
+
+    if (options.sound.isEmpty())
+        options.sound = sounds[0];
+
+    const auto shouldRun = [&options](const char* name) { return options.only.isEmpty() || juce::String(name).startsWith(options.only); };
+
+    juce::Array<juce::var> benchmarks;
+    const auto add = [&benchmarks](juce::var result)
+    {
+        if (! result.isVoid())
+        {
+            benchmarks.add(result);
+            std::cerr << "." << std::flush;
+        }
+    };
+
+    // La carga va la primera para que la medida en frío no salga ya de la caché
+    if (shouldRun("load"))
+    {
+        add(benchmarkLoad(options.sound, true));
+
+        for (int i = 0; i < 5; ++i)
+            add(benchmarkLoad(options.sound, false));
+    }
+
+    if (shouldRun("decrypt"))
+        add(benchmarkDecrypt(options.sound, 5));
+
+    if (shouldRun("processBlock"))
+    {
+        for (auto loop : { false, true })
+            for (auto numNotes : { 1, 8, 32 })
+                for (int blockSize = 16; blockSize <= 4096; blockSize *= 2)
+                    add(benchmarkProcessBlock(options, { blockSize, numNotes, loop }));
+
+        // Cada opción cara por separado frente al caso por defecto (Hermite, sin filtro, en serie)
+        for (auto numNotes : { 8, 32 })
+        {
+            for (auto blockSize : { 64, 256, 1024 })
+            {
+                ProcessBlockCase test;
+                test.blockSize = blockSize;
+                test.numNotes = numNotes;
+
+                auto filtered = test;
+                filtered.filter = true;
+                add(benchmarkProcessBlock(options, filtered));
+
+                auto parallel = test;
+                parallel.parallel = true;
+                add(benchmarkProcessBlock(options, parallel));
+
+                for (auto interpolation : { 0, 2 })
+                {
+                    auto interpolated = test;
+                    interpolated.interpolation = interpolation;
+                    add(benchmarkProcessBlock(options, interpolated));
+                }
+            }
+        }
+    }
+
+    if (shouldRun("waveform"))
+        if (auto peaks = buildPeaks(options.sound))
+            for (auto width : { 400, 1600, 3840 })
+                add(benchmarkWaveform(peaks, width, 200, 20));
+
+    std::cerr << std::endl;
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("version", juce::String(ProjectInfo::versionString));
+    report->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    report->setProperty("sampleRate", sampleRate);
+    report->setProperty("sound", options.sound);
+    report->setProperty("benchmarks", benchmarks);
+
+    const auto json = juce::JSON::toString(juce::var(report));
+
+    if (outputFile != juce::File())
+    {
+        if (! outputFile.replaceWithText(json))
+        {
+            std::cerr << "Error: cannot write " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << json << std::endl;
+    }
+
+    return 0;
+}
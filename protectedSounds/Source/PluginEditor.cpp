@@ -7,6 +7,14 @@ ProtectedSoundsAudioProcessorEditor::ProtectedSoundsAudioProcessorEditor(Protect
     setupSliders();
     setupLabels();
     
+    // Forma de onda: arrastrar un marcador mueve su slider, que a su vez actualiza el loop
+    addAndMakeVisible(waveformDisplay);
+    waveformDisplay.onLoopStartDragged = [this](double fraction) {
+        loopStartSlider.setValue(fraction * audioProcessor.getAudioLength() * 1000.0, juce::sendNotification);
+    };
+    waveformDisplay.onLoopEndDragged = [this](double fraction) {
+        loopEndSlider.setValue(fraction * audioProcessor.getAudioLength() * 1000.0, juce::sendNotification);
+    };
 
     // Setup sound selectors
     addAndMakeVisible(soundSelector1);
@@ -27,6 +35,28 @@ ProtectedSoundsAudioProcessorEditor::ProtectedSoundsAudioProcessorEditor(Protect
     mixAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "MixAmount", mixSlider);
     
+    // Nivel de salida
+    outputLevelSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
+    outputLevelSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 40, 20);
+    addAndMakeVisible(outputLevelSlider);
+
+    outputLevelLabel.setText("Level dB", juce::dontSendNotification);
+    outputLevelLabel.attachToComponent(&outputLevelSlider, false);
+
+    outputLevelAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "OutputLevel", outputLevelSlider);
+    
+    // Crossfade de la costura del loop
+    loopCrossfadeSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
+    loopCrossfadeSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 40, 20);
+    addAndMakeVisible(loopCrossfadeSlider);
+
+    loopCrossfadeLabel.setText("Xfade ms", juce::dontSendNotification);
+    loopCrossfadeLabel.attachToComponent(&loopCrossfadeSlider, false);
+
+    loopCrossfadeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "LoopCrossfade", loopCrossfadeSlider);
+    
     auto sounds = audioProcessor.getAvailableSounds();
     soundSelector1.addItemList(sounds, 1);
     soundSelector2.addItemList(sounds, 1);
@@ -73,11 +103,113 @@ ProtectedSoundsAudioProcessorEditor::ProtectedSoundsAudioProcessorEditor(Protect
 
     
 
+    // Calidad de interpolación; los elementos tienen que existir antes de crear el attachment
+    interpolationSelector.addItemList({ "Linear", "Hermite", "Sinc" }, 1);
+    addAndMakeVisible(interpolationSelector);
+    interpolationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "Interpolation", interpolationSelector);
+
+    // Voces activas, actualizado desde la telemetría
+    activeVoicesLabel.setJustificationType(juce::Justification::centredRight);
+    addAndMakeVisible(activeVoicesLabel);
+
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    cpuMeterButton.setButtonText("CPU --");
+    cpuMeterButton.onClick = [this] { saveCpuReport(); };
+    addAndMakeVisible(cpuMeterButton);
+   #endif
+
     setSize(800, 300);
-    
+    refreshWaveform();
+
+    startTimerHz(telemetryRefreshHz);
+}
+
+ProtectedSoundsAudioProcessorEditor::~ProtectedSoundsAudioProcessorEditor()
+{
+    stopTimer();
 }
 
-ProtectedSoundsAudioProcessorEditor::~ProtectedSoundsAudioProcessorEditor() = default;
+void ProtectedSoundsAudioProcessorEditor::timerCallback()
+{
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    if (--cpuMeterCountdown <= 0)
+    {
+        cpuMeterCountdown = telemetryRefreshHz / cpuMeterRefreshHz;
+        updateCpuMeter();
+    }
+   #endif
+
+    TelemetryFrame frame;
+
+    if (! audioProcessor.pullTelemetry(frame))
+        return;
+
+    // La forma de onda es la del selector 1: sólo se dibujan sus voces
+    std::array<WaveformDisplay::Playhead, WaveformDisplay::maxPlayheads> playheads;
+    int numPlayheads = 0;
+
+    for (int i = 0; i < frame.numVoices && numPlayheads < WaveformDisplay::maxPlayheads; ++i)
+    {
+        const auto& voice = frame.voices[(size_t) i];
+
+        if (voice.layer != 0)
+            continue;
+
+        playheads[(size_t) numPlayheads++] = { voice.position, voice.level,
+                                               voice.stage == VoiceTelemetry::Stage::release };
+    }
+
+    waveformDisplay.setPlayheads(playheads.data(), numPlayheads);
+
+    if (frame.numActiveVoices != shownActiveVoices)
+    {
+        shownActiveVoices = frame.numActiveVoices;
+        activeVoicesLabel.setText("Voices: " + juce::String(shownActiveVoices), juce::dontSendNotification);
+    }
+}
+
+#if PROTECTEDSOUNDS_INSTRUMENTATION
+void ProtectedSoundsAudioProcessorEditor::updateCpuMeter()
+{
+    auto& instrumentation = audioProcessor.getInstrumentation();
+
+    const auto averageLoad = instrumentation.getAverageLoad(cpuLoadReading);
+    const auto peakLoad = instrumentation.pullPeakLoad();
+    const auto deadlineMisses = instrumentation.getNumDeadlineMisses();
+
+    // Rojo hasta la siguiente actualización si ha habido fallos de plazo nuevos
+    const auto missedDeadline = deadlineMisses > shownDeadlineMisses;
+    shownDeadlineMisses = deadlineMisses;
+
+    cpuMeterButton.setButtonText("CPU " + juce::String(juce::roundToInt(averageLoad * 100.0f))
+                                 + "/" + juce::String(juce::roundToInt(peakLoad * 100.0f)) + "%");
+    if (missedDeadline)
+        cpuMeterButton.setColour(juce::TextButton::textColourOffId, juce::Colours::red);
+    else
+        cpuMeterButton.removeColour(juce::TextButton::textColourOffId);
+}
+
+void ProtectedSoundsAudioProcessorEditor::saveCpuReport()
+{
+    cpuReportChooser = std::make_unique<juce::FileChooser>("Save CPU report",
+        juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("protectedSounds-cpu.json"),
+        "*.json");
+
+    cpuReportChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting,
+                                  [safeThis = juce::Component::SafePointer<ProtectedSoundsAudioProcessorEditor>(this)](const juce::FileChooser& chooser)
+    {
+        if (safeThis == nullptr)
+            return;
+
+        const auto file = chooser.getResult();
+
+        // El informe se copia de los contadores en el momento de guardar
+        if (file != juce::File())
+            file.replaceWithText(safeThis->audioProcessor.getInstrumentation().createReport());
+    });
+}
+#endif
 
 void ProtectedSoundsAudioProcessorEditor::setupButtons()
 {
@@ -85,6 +217,7 @@ void ProtectedSoundsAudioProcessorEditor::setupButtons()
     loopButton.setToggleState(false, juce::dontSendNotification);
     loopButton.onClick = [this]() {
         audioProcessor.setLoopEnabled(loopButton.getToggleState());
+        updateWaveformOverlay();
     };
 }
 
@@ -125,6 +258,26 @@ void ProtectedSoundsAudioProcessorEditor::setupSliders()
     mReleaseAttachment2 = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "Release2", mReleaseSlider2);
     
+    // Filtro de las voces
+    auto setupFilterSlider = [this](juce::Slider& slider, juce::Label& label, const juce::String& text) {
+        addAndMakeVisible(slider);
+        slider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
+        slider.setTextBoxStyle(juce::Slider::TextBoxBelow, true, 50, 20);
+        label.setText(text, juce::dontSendNotification);
+        label.attachToComponent(&slider, false);
+    };
+
+    setupFilterSlider(filterFreqSlider, filterFreqLabel, "Cutoff Hz");
+    setupFilterSlider(filterResSlider, filterResLabel, "Res");
+    addAndMakeVisible(filterButton);
+
+    filterFreqAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "FilterFreq", filterFreqSlider);
+    filterResAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "FilterRes", filterResSlider);
+    filterButtonAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        audioProcessor.getAPVTS(), "FilterEnabled", filterButton);
+    
     addAndMakeVisible(loopStartSlider);
     addAndMakeVisible(loopEndSlider);
     addAndMakeVisible(loopStartLabel);
@@ -158,6 +311,24 @@ void ProtectedSoundsAudioProcessorEditor::updateLoopPoints()
     DBG("Setting loop points - End samples: " << endSamples);
     
     audioProcessor.setLoopPoints(startSamples, endSamples);
+    updateWaveformOverlay();
+}
+
+void ProtectedSoundsAudioProcessorEditor::refreshWaveform()
+{
+    waveformDisplay.setPeaks(audioProcessor.getWaveformPeaks());
+    updateWaveformOverlay();
+}
+
+void ProtectedSoundsAudioProcessorEditor::updateWaveformOverlay()
+{
+    // Los sliders están en ms; la forma de onda usa fracciones de la duración
+    const auto lengthMs = audioProcessor.getAudioLength() * 1000.0;
+
+    if (lengthMs > 0.0)
+        waveformDisplay.setLoopRegion(audioProcessor.isLooping(),
+                                      loopStartSlider.getValue() / lengthMs,
+                                      loopEndSlider.getValue() / lengthMs);
 }
 
 void ProtectedSoundsAudioProcessorEditor::setupLabels()
@@ -182,154 +353,44 @@ void ProtectedSoundsAudioProcessorEditor::setupLabels()
 
 void ProtectedSoundsAudioProcessorEditor::paint(juce::Graphics& g)
 {
+    // La forma de onda y sus marcadores los pinta waveformDisplay
     g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
-
-    auto waveform = audioProcessor.getWaveForm();
-    
-    if (waveform.getNumSamples() > 0)
-    {
-        juce::Path p;
-        audioPoints.clear();
-        
-        // Área para dibujar la forma de onda
-        auto waveformBounds = getLocalBounds().reduced(10).removeFromTop(100);
-        
-        auto ratio = waveform.getNumSamples() / waveformBounds.getWidth();
-        auto buffer = waveform.getReadPointer(0);
-        
-        // Escalar audio al ancho de la ventana
-        for (int sample = 0; sample < waveform.getNumSamples(); sample += ratio)
-        {
-            audioPoints.push_back(buffer[sample]);
-        }
-        
-        g.setColour(juce::Colours::yellow);
-        p.startNewSubPath(waveformBounds.getX(), waveformBounds.getCentreY());
-        
-        // Escalar en el eje Y
-        for (int sample = 0; sample < audioPoints.size(); ++sample)
-        {
-            auto point = juce::jmap<float>(audioPoints[sample], -1.0f, 1.0f,
-                                         waveformBounds.getBottom(), waveformBounds.getY());
-            p.lineTo(waveformBounds.getX() + sample, point);
-        }
-        
-        g.strokePath(p, juce::PathStrokeType(2));
-        
-        // Dibujar marcadores de loop
-        if (audioProcessor.isLooping())
-        {
-            auto startX = juce::jmap<float>(audioProcessor.getLoopStart(),
-                                          0.0f, audioProcessor.getAudioLength(),
-                                          waveformBounds.getX(), waveformBounds.getRight());
-            
-            auto endX = juce::jmap<float>(audioProcessor.getLoopEnd(),
-                                        0.0f, audioProcessor.getAudioLength(),
-                                        waveformBounds.getX(), waveformBounds.getRight());
-            
-            g.setColour(juce::Colours::red);
-            g.drawLine(startX, waveformBounds.getY(), startX, waveformBounds.getBottom(), 2.0f);
-            g.drawLine(endX, waveformBounds.getY(), endX, waveformBounds.getBottom(), 2.0f);
-        }
-    }
-    
-    auto waveformBounds = getLocalBounds().reduced(10).removeFromTop(100);
-
-    // Dibujar marcadores de loop como áreas interactivas
-    if (audioProcessor.isLooping())
-    {
-        auto startX = juce::jmap<float>(audioProcessor.getLoopStart(),
-                                      0.0f, audioProcessor.getAudioLength(),
-                                      waveformBounds.getX(), waveformBounds.getRight());
-        
-        auto endX = juce::jmap<float>(audioProcessor.getLoopEnd(),
-                                    0.0f, audioProcessor.getAudioLength(),
-                                    waveformBounds.getX(), waveformBounds.getRight());
-        
-        g.setColour(juce::Colours::red);
-        
-        // Dibujar marcadores con áreas para arrastrar
-        g.drawLine(startX, waveformBounds.getY(), startX, waveformBounds.getBottom(), 2.0f);
-        g.drawLine(endX, waveformBounds.getY(), endX, waveformBounds.getBottom(), 2.0f);
-        
-        // Áreas de agarre
-        g.setColour(juce::Colours::red.withAlpha(0.3f));
-        g.fillRect(juce::Rectangle<float>(startX - markerDragTolerance,
-                                         waveformBounds.getY(),
-                                         markerDragTolerance * 2,
-                                         waveformBounds.getHeight()));
-        g.fillRect(juce::Rectangle<float>(endX - markerDragTolerance,
-                                         waveformBounds.getY(),
-                                         markerDragTolerance * 2,
-                                         waveformBounds.getHeight()));
-    }
 }
 
-
-void ProtectedSoundsAudioProcessorEditor::mouseDown(const juce::MouseEvent& e)
-{
-    auto waveformBounds = getLocalBounds().reduced(10).removeFromTop(100);
-    
-    auto startX = juce::jmap<float>(audioProcessor.getLoopStart(),
-                                  0.0f, audioProcessor.getAudioLength(),
-                                  waveformBounds.getX(), waveformBounds.getRight());
-    
-    auto endX = juce::jmap<float>(audioProcessor.getLoopEnd(),
-                                0.0f, audioProcessor.getAudioLength(),
-                                waveformBounds.getX(), waveformBounds.getRight());
-    
-    if (std::abs(e.x - startX) < markerDragTolerance && waveformBounds.contains(e.getPosition()))
-        isDraggingStartMarker = true;
-    else if (std::abs(e.x - endX) < markerDragTolerance && waveformBounds.contains(e.getPosition()))
-        isDraggingEndMarker = true;
-}
-
-void ProtectedSoundsAudioProcessorEditor::mouseDrag(const juce::MouseEvent& e)
-{
-    if (isDraggingStartMarker || isDraggingEndMarker)
-    {
-        auto waveformBounds = getLocalBounds().reduced(10).removeFromTop(100);
-        auto timeInMs = juce::jmap<float>(e.x,
-                                        waveformBounds.getX(), waveformBounds.getRight(),
-                                        0.0f, audioProcessor.getAudioLength() * 1000.0f);
-        
-        timeInMs = juce::jlimit<float>(0.0f, audioProcessor.getAudioLength() * 1000.0f, timeInMs);
-        
-        if (isDraggingStartMarker)
-        {
-            loopStartSlider.setValue(timeInMs, juce::sendNotification);
-        }
-        else
-        {
-            loopEndSlider.setValue(timeInMs, juce::sendNotification);
-        }
-        
-        repaint();
-    }
-}
-
-void ProtectedSoundsAudioProcessorEditor::mouseUp(const juce::MouseEvent&)
-{
-    isDraggingStartMarker = false;
-    isDraggingEndMarker = false;
-}
-
-
 void ProtectedSoundsAudioProcessorEditor::resized()
 {
     auto area = getLocalBounds().reduced(10);
     
     auto waveformArea = area.removeFromTop(100);
+    waveformDisplay.setBounds(waveformArea);
     
     // Area para controles de loop
     auto loopArea = area.removeFromTop(90);
     auto loopControlsLeft = loopArea.removeFromLeft(400);
     
+    // Nivel de salida
+    outputLevelSlider.setBounds(loopArea.removeFromLeft(80).reduced(5));
+    
+    // Filtro
+    filterButton.setBounds(loopArea.removeFromLeft(70).removeFromTop(30).reduced(5));
+    filterFreqSlider.setBounds(loopArea.removeFromLeft(80).reduced(5));
+    filterResSlider.setBounds(loopArea.removeFromLeft(80).reduced(5));
+    
     // Mix control
     mixSlider.setBounds(loopControlsLeft.removeFromRight(100).reduced(5));
     
-    // Botón de loop
-    loopButton.setBounds(loopControlsLeft.removeFromTop(30).removeFromLeft(100).reduced(5));
+    // Crossfade del loop
+    loopCrossfadeSlider.setBounds(loopControlsLeft.removeFromRight(80).reduced(5));
+    
+    // Botón de loop, voces activas y medidor de CPU
+    auto buttonRow = loopControlsLeft.removeFromTop(30);
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    loopButton.setBounds(buttonRow.removeFromLeft(70).reduced(5));
+    cpuMeterButton.setBounds(buttonRow.removeFromRight(80).reduced(3));
+   #else
+    loopButton.setBounds(buttonRow.removeFromLeft(100).reduced(5));
+   #endif
+    activeVoicesLabel.setBounds(buttonRow.reduced(5));
     
     loopControlsLeft.removeFromTop(5);
     
@@ -364,4 +425,5 @@ void ProtectedSoundsAudioProcessorEditor::resized()
     // Sound selectors
     soundSelector1.setBounds(getWidth()/2 + 100, getHeight()/2 - 50, 100, 50);
     soundSelector2.setBounds(getWidth()/2 - 300, getHeight()/2 - 50, 100, 50);
+    interpolationSelector.setBounds(getWidth()/2 + 210, getHeight()/2 - 40, 90, 30);
 } 
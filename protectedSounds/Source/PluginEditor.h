@@ -1,8 +1,10 @@
 #pragma once
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "WaveformDisplay.h"
 
-class ProtectedSoundsAudioProcessorEditor : public juce::AudioProcessorEditor
+class ProtectedSoundsAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                            private juce::Timer
 {
 public:
     explicit ProtectedSoundsAudioProcessorEditor(ProtectedSoundsAudioProcessor&);
@@ -16,9 +18,8 @@ public:
     juce::Label loopStartLabel{"", "Loop Start (ms)"};
     juce::Label loopEndLabel{"", "Loop End (ms)"};
     
-    void mouseDown(const juce::MouseEvent& e) override;
-    void mouseDrag(const juce::MouseEvent& e) override;
-    void mouseUp(const juce::MouseEvent& e) override;
+    // Sonido o duración nuevos: recoge los picos del procesador y recoloca el loop
+    void refreshWaveform();
 
 private:
     ProtectedSoundsAudioProcessor& audioProcessor;
@@ -27,6 +28,10 @@ private:
     juce::ComboBox soundSelector1;
     juce::ComboBox soundSelector2;
 
+    // Calidad de interpolación
+    juce::ComboBox interpolationSelector;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> interpolationAttachment;
+
     // Loop control
     juce::ToggleButton loopButton{"Loop"};
 
@@ -38,13 +43,11 @@ private:
     //filtro
     juce::Slider filterFreqSlider;
     juce::Slider filterResSlider;
+    juce::ToggleButton filterButton{"Filter"};
     juce::Label filterFreqLabel;
     juce::Label filterResLabel;
     
-    std::unique_ptr<juce::AudioFormatReader> formatReader;
-    juce::AudioBuffer<float> waveForm;
     juce::String fileName;
-    std::vector<float> audioPoints;
 
     // APVTS attachments
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mAttackAttachment;
@@ -58,19 +61,46 @@ private:
     //filtro
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> filterFreqAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> filterResAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> filterButtonAttachment;
     
     void setupSliders();
     void setupLabels();
     void setupButtons();
     void updateLoopPoints();
+    void updateWaveformOverlay();
+
+    // Lee la telemetría del procesador al ritmo de refresco de la pantalla
+    void timerCallback() override;
+    static constexpr int telemetryRefreshHz = 60;
+    
+    WaveformDisplay waveformDisplay;
+    juce::Label activeVoicesLabel;
+    int shownActiveVoices { -1 };
+    
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    // Carga media y de pico de processBlock, unas pocas veces por segundo; en rojo si algún
+    // bloque se ha pasado del plazo. Al pulsarlo se guarda el informe completo en JSON
+    void updateCpuMeter();
+    void saveCpuReport();
+    static constexpr int cpuMeterRefreshHz = 4;
+    juce::TextButton cpuMeterButton;
+    ProcessingInstrumentation::LoadReading cpuLoadReading;
+    juce::uint64 shownDeadlineMisses { 0 };
+    int cpuMeterCountdown { 0 };
+    std::unique_ptr<juce::FileChooser> cpuReportChooser;
+   #endif
     
     juce::Slider mixSlider;
     juce::Label mixLabel;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mixAttachment;
     
-    bool isDraggingStartMarker = false;
-    bool isDraggingEndMarker = false;
-    float markerDragTolerance = 5.0f; // pixels
-
+    juce::Slider outputLevelSlider;
+    juce::Label outputLevelLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> outputLevelAttachment;
+    
+    juce::Slider loopCrossfadeSlider;
+    juce::Label loopCrossfadeLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> loopCrossfadeAttachment;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProtectedSoundsAudioProcessorEditor)
 };
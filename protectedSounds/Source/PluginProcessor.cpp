@@ -21,21 +21,54 @@ ProtectedSoundsAudioProcessor::ProtectedSoundsAudioProcessor()
     limiter.setThreshold(0.0f);
     limiter.setRelease(100.0f);
 
-    // Escuchar cambios en parámetros
-    apvts.state.addListener(this);
-    
-    // Inicializar voces para todos los samplers
-    for(int i = 0; i < mNumVoices; i++) {
-        mSampler1Clean.addVoice(new juce::SamplerVoice());
-        mSampler1Excited.addVoice(new juce::SamplerVoice());
-        mSampler2Clean.addVoice(new juce::SamplerVoice());
-        mSampler2Excited.addVoice(new juce::SamplerVoice());
-    }
+    // Los punteros se resuelven aquí una vez; processBlock no busca parámetros por nombre
+    auto pointer = [this](const char* parameterID) {
+        auto* value = apvts.getRawParameterValue(parameterID);
+        jassert(value != nullptr);
+        return value;
+    };
+    
+    parameters.attack[0] = pointer("Attack");
+    parameters.decay[0] = pointer("Decay");
+    parameters.sustain[0] = pointer("Sustain");
+    parameters.release[0] = pointer("Release");
+    parameters.attack[1] = pointer("Attack2");
+    parameters.decay[1] = pointer("Decay2");
+    parameters.sustain[1] = pointer("Sustain2");
+    parameters.release[1] = pointer("Release2");
+    parameters.filterEnabled = pointer("FilterEnabled");
+    parameters.filterType = pointer("FilterType");
+    parameters.filterFreq = pointer("FilterFreq");
+    parameters.filterRes = pointer("FilterRes");
+    parameters.filterEnvAmount = pointer("FilterEnvAmount");
+    parameters.filterVelAmount = pointer("FilterVelAmount");
+    parameters.loopCrossfade = pointer("LoopCrossfade");
+    parameters.mixAmount = pointer("MixAmount");
+    parameters.outputLevel = pointer("OutputLevel");
+    parameters.interpolation = pointer("Interpolation");
+    parameters.polyphony = pointer("Polyphony");
+    parameters.voiceStealing = pointer("VoiceStealing");
+    parameters.parallelLayers = pointer("ParallelLayers");
+    
+    // Escuchar cambios en parámetros por grupos
+    addParameterGroup(envelope1Group, { "Attack", "Decay", "Sustain", "Release" });
+    addParameterGroup(envelope2Group, { "Attack2", "Decay2", "Sustain2", "Release2" });
+    addParameterGroup(filterGroup, { "FilterEnabled", "FilterType", "FilterFreq", "FilterRes", "FilterEnvAmount", "FilterVelAmount" });
+    addParameterGroup(loopGroup, { "LoopCrossfade" });
+    addParameterGroup(mixLevelGroup, { "MixAmount", "OutputLevel" });
+    addParameterGroup(interpolationGroup, { "Interpolation" });
+    addParameterGroup(voicePoolGroup, { "Polyphony", "VoiceStealing" });
+    addParameterGroup(renderGroup, { "ParallelLayers" });
+    apvts.addParameterListener("ParallelLayers", &renderPoolListener);
 }
 
 ProtectedSoundsAudioProcessor::~ProtectedSoundsAudioProcessor()
 {
-    apvts.state.removeListener(this);
+    for (int i = 0; i < parameterListeners.size(); ++i)
+        apvts.removeParameterListener(listenedParameterIDs[i], parameterListeners[i]);
+    
+    apvts.removeParameterListener("ParallelLayers", &renderPoolListener);
+    
     mFormatReader = nullptr;
     mFormatReader2 = nullptr;
 }
@@ -94,32 +127,73 @@ void ProtectedSoundsAudioProcessor::changeProgramName(int index, const juce::Str
 void ProtectedSoundsAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     // Configurar sample rate para todos los samplers
-    mSampler1Clean.setCurrentPlaybackSampleRate(sampleRate);
-    mSampler1Excited.setCurrentPlaybackSampleRate(sampleRate);
-    mSampler2Clean.setCurrentPlaybackSampleRate(sampleRate);
-    mSampler2Excited.setCurrentPlaybackSampleRate(sampleRate);
+    mSampler1.setCurrentPlaybackSampleRate(sampleRate);
+    mSampler2.setCurrentPlaybackSampleRate(sampleRate);
+    
+    // Si cambia la frecuencia (o es la primera y ya se cargó algo sin conocerla), los sonidos se
+    // vuelven a pedir convertidos a la nueva y los puntos de loop, en samples del host, se
+    // reescalan. Mientras llegan, las voces transponen los que había, que siguen sonando afinados
+    if (sampleRate != preparedSampleRate)
+    {
+        if (preparedSampleRate > 0.0)
+        {
+            const auto scale = sampleRate / preparedSampleRate;
+            loopStartPosition.store((int64_t) std::llround(loopStartPosition.load() * scale));
+            loopEndPosition.store((int64_t) std::llround(loopEndPosition.load() * scale));
+        }
+        else if (const auto pendingStart = pendingLoopStartSeconds.exchange(-1.0); pendingStart >= 0.0)
+        {
+            // Sonido elegido antes de conocer la frecuencia: el loop se guardó en segundos
+            loopStartPosition.store((int64_t) std::llround(pendingStart * sampleRate));
+            loopEndPosition.store((int64_t) std::llround(pendingLoopEndSeconds.load() * sampleRate));
+            
+            juce::MessageManager::callAsync([weakThis = juce::WeakReference<ProtectedSoundsAudioProcessor>(this)]
+            {
+                if (auto* processor = weakThis.get())
+                    processor->updateEditorLoopSliders();
+            });
+        }
+        
+        sampleLoader.requestReloadAll();
+    }
+    
+    preparedSampleRate = sampleRate;
+    
+    // Tamaño máximo de trozo de render; processBlock no debe asignar memoria
+    maxBlockSize = juce::jmax(1, samplesPerBlock);
+    rampBuffer.setSize(numRampChannels, maxBlockSize);
+    layerBuffer.setSize(2, maxBlockSize);
     
-    // Preparar buffer temporal
-    tempBuffer.setSize(getTotalNumOutputChannels(), samplesPerBlock);
+    // Las rampas empiezan en el valor actual: nada de fundidos al arrancar
+    mixSmoother.reset(sampleRate, parameterRampSeconds, parameters.mixAmount->load() / 100.0f);
+    levelSmoother.reset(sampleRate, parameterRampSeconds, juce::Decibels::decibelsToGain(parameters.outputLevel->load()));
     
-    updateADSR();
+    // Con otra frecuencia de muestreo hay que rehacer todo lo que depende de ella (el loop, p. ej.)
+    markParametersDirty(allParameterGroups);
     
-    // Configurar DSP (filtro y limitador)
+    // Configurar DSP (limitador; el filtro va en cada voz)
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
-    spec.maximumBlockSize = samplesPerBlock;
+    spec.maximumBlockSize = (juce::uint32) maxBlockSize;
     spec.numChannels = getTotalNumOutputChannels();
     
-    filter.prepare(spec);
-    filter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-    filter.setCutoffFrequency(filterFrequency);
-    filter.setResonance(filterResonance);
-    
     limiter.prepare(spec);
+    
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    instrumentation.prepare(sampleRate);
+   #endif
 }
 
 void ProtectedSoundsAudioProcessor::releaseResources() {}
 
+void ProtectedSoundsAudioProcessor::reset()
+{
+    // Salto de transporte o render nuevo: sin notas colgadas ni colas del limitador
+    mSampler1.allNotesOff(0, false);
+    mSampler2.allNotesOff(0, false);
+    limiter.reset();
+}
+
 bool ProtectedSoundsAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
     if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
@@ -136,128 +210,201 @@ void ProtectedSoundsAudioProcessor::processBlock(juce::AudioBuffer<float>& buffe
 {
     juce::ScopedNoDenormals noDenormals;
     
-    // Buffer para procesar mensajes MIDI (incluyendo loops artificiales)
-    juce::MidiBuffer processedMidi;
+    const int totalSamples = buffer.getNumSamples();
+    
+    // Sin prepareToPlay no hay buffers reservados: no renderizar nada
+    if (maxBlockSize <= 0)
+    {
+        buffer.clear();
+        return;
+    }
+    
+    // Coste de cada etapa frente al plazo del bloque (sólo con PROTECTEDSOUNDS_INSTRUMENTATION)
+    PROTECTEDSOUNDS_INSTRUMENT_BLOCK(instrumentation, totalSamples, ! isNonRealtime());
     
-    // ========================================================================
-    // PROCESAMIENTO DE MENSAJES MIDI Y GESTIÓN DEL LOOP
-    // ========================================================================
+    // Limpiar buffer de salida
+    buffer.clear();
     
-    // Copiar mensajes MIDI originales y procesar note on/off
-    for (const auto metadata : midiMessages)
     {
-        processedMidi.addEvent(metadata.getMessage(), metadata.samplePosition);
-        auto message = metadata.getMessage();
+        PROTECTEDSOUNDS_INSTRUMENT_STAGE(instrumentation, midiStage);
         
-        if (message.isNoteOn())
-        {
-            isNotePlaying.store(true);
-            currentNoteNumber.store(message.getNoteNumber());
-            
-            // Establecer posición inicial según si el loop está habilitado
-            if (loopEnabled.load()) {
-                currentSamplePosition.store(loopStartPosition.load());
-            } else {
-                currentSamplePosition.store(0);
-            }
-        }
-        else if (message.isNoteOff() && message.getNoteNumber() == currentNoteNumber.load())
-        {
-            // Solo detener si el loop no está habilitado
-            if (!loopEnabled.load()) {
-                isNotePlaying.store(false);
-                currentNoteNumber.store(-1);
-                currentSamplePosition.store(0);
-            }
-        }
+        // Adoptar los sonidos que haya publicado el cargador (intercambio atómico, sin locks)
+        mSampler1.updateSampleData();
+        mSampler2.updateSampleData();
+     
+        // Aplicar sólo los grupos de parámetros que han cambiado desde el último bloque
+        if (const auto dirtyGroups = dirtyParameterGroups.exchange(0, std::memory_order_acquire))
+            applyParameterChanges(dirtyGroups);
     }
-
-    // Limpiar buffers
-    buffer.clear();
-    tempBuffer.clear();
- 
-    // Actualizar ADSR si es necesario
-    if (sUpdate) {
-        updateADSR();
+    
+    // Si el host manda un bloque mayor que el preparado, se procesa en trozos
+    // de maxBlockSize para no tener que redimensionar nada aquí
+    for (int chunkStart = 0; chunkStart < totalSamples; chunkStart += maxBlockSize)
+    {
+        const int chunkSamples = juce::jmin(maxBlockSize, totalSamples - chunkStart);
+        
+        // Más rápido que tiempo real el streamer no llega: offline se puede bloquear, así que
+        // se espera en vez de dejar que las voces en streaming se queden en silencio. Sólo si a
+        // alguna le faltan frames para este trozo: con sonidos en memoria no se espera nunca
+        if (isNonRealtime() && ! (mSampler1.isStreamBuffered(chunkSamples) && mSampler2.isStreamBuffered(chunkSamples)))
+            sampleStreamer.waitUntilBuffered(offlineStreamTimeoutMs);
+        
+        // Las voces suman directamente en el buffer de salida
+        renderSamplers(buffer, midiMessages, chunkStart, chunkSamples);
+        applyOutputLevel(buffer, chunkStart, chunkSamples);
+        
+        // Aplicar limitador final
+        PROTECTEDSOUNDS_INSTRUMENT_STAGE(instrumentation, limiterStage);
+        juce::dsp::AudioBlock<float> audioBlock(buffer);
+        auto chunkBlock = audioBlock.getSubBlock((size_t) chunkStart, (size_t) chunkSamples);
+        juce::dsp::ProcessContextReplacing<float> context(chunkBlock);
+        limiter.process(context);
     }
 
-    // ========================================================================
-    // LÓGICA DEL LOOP - GESTIÓN DE POSICIÓN Y REINICIO
-    // ========================================================================
+    // Una foto por bloque para el editor; si nadie la lee se descarta
+    TelemetryFrame frame;
+    mSampler1.fillTelemetry(frame, 0);
+    mSampler2.fillTelemetry(frame, 1);
+    telemetry.push(frame);
     
-    if (isNotePlaying.load())
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    // Las notas se procesan dentro del render de cada sampler: su tiempo pasa a la etapa MIDI
+    instrumentation.moveCycles(ProcessingInstrumentation::sampler1Stage, ProcessingInstrumentation::midiStage,
+                               mSampler1.takeMidiCycles());
+    instrumentation.moveCycles(ProcessingInstrumentation::sampler2Stage, ProcessingInstrumentation::midiStage,
+                               mSampler2.takeMidiCycles());
+   #endif
+}
+
+void ProtectedSoundsAudioProcessor::renderSamplers(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages,
+                                                   int startSample, int numSamples)
+{
+    // El trozo se parte donde termina la rampa de la mezcla: durante la rampa las voces leen
+    // las ganancias por sample y después vuelven a las constantes, sin coste extra
+    const auto endSample = startSample + numSamples;
+    
+    // layerBuffer se indexa con las posiciones del buffer del host (las de los eventos MIDI):
+    // sólo sirve para el trozo que cae dentro de él. Si el host manda bloques mayores que los
+    // preparados, en los trozos siguientes las dos capas suman directamente en la salida, en serie
+    const bool separateLayers = endSample <= layerBuffer.getNumSamples();
+    const auto numLayerChannels = juce::jmin(layerBuffer.getNumChannels(), buffer.getNumChannels());
+    juce::AudioBuffer<float> layerOutput(layerBuffer.getArrayOfWritePointers(), numLayerChannels,
+                                         separateLayers ? endSample : 0);
+    
+    if (separateLayers)
+        layerOutput.clear(startSample, numSamples);
+    
+    LayerRenderJob layerJobs[2];
+    RenderJob* const jobs[2] = { &layerJobs[0], &layerJobs[1] };
+    
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    layerJobs[0].cycles = &instrumentation.getStageCycles(ProcessingInstrumentation::sampler1Stage);
+    layerJobs[1].cycles = &instrumentation.getStageCycles(ProcessingInstrumentation::sampler2Stage);
+   #endif
+    
+    for (int segmentStart = startSample; segmentStart < endSample;)
     {
-        int64_t newPosition = currentSamplePosition.load() + buffer.getNumSamples();
+        auto segmentSamples = endSample - segmentStart;
         
-        if (loopEnabled.load())
+        if (mixSmoother.isSmoothing())
         {
-            int64_t loopEnd = loopEndPosition.load();
-            int64_t loopStart = loopStartPosition.load();
+            PROTECTEDSOUNDS_INSTRUMENT_STAGE(instrumentation, mixStage);
+            segmentSamples = juce::jmin(segmentSamples, mixSmoother.getSamplesToTarget());
             
-            // Si llegamos al final del loop, reiniciar
-            if (newPosition >= loopEnd)
-            {
-                currentSamplePosition.store(loopStart);
-                
-                // Enviar note-off y note-on para reiniciar el sample
-                int currentNote = currentNoteNumber.load();
-                processedMidi.addEvent(juce::MidiMessage::noteOff(1, currentNote, (uint8_t)64), 0);
-                processedMidi.addEvent(juce::MidiMessage::noteOn(1, currentNote, (uint8_t)127), 1);
-            }
-            else
-            {
-                currentSamplePosition.store(newPosition);
-            }
+            auto* mix = rampBuffer.getWritePointer(mixRamp);
+            auto* cleanGains = rampBuffer.getWritePointer(cleanGainRamp);
+            auto* excitedGains = rampBuffer.getWritePointer(excitedGainRamp);
+            
+            mixSmoother.fillRamp(mix, segmentSamples);
+            EqualPowerCrossfade::fillGains(mix, cleanGains, excitedGains, segmentSamples);
+            
+            mSampler1.setMixGainRamp(cleanGains, excitedGains, segmentStart);
+            mSampler2.setMixGainRamp(cleanGains, excitedGains, segmentStart);
         }
         else
         {
-            currentSamplePosition.store(newPosition);
+            float cleanGain, excitedGain;
+            EqualPowerCrossfade::getGains(mixSmoother.getCurrentValue(), cleanGain, excitedGain);
+            
+            mSampler1.setMixGains(cleanGain, excitedGain);
+            mSampler2.setMixGains(cleanGain, excitedGain);
         }
+        
+        layerJobs[0].set(mSampler1, buffer, midiMessages, segmentStart, segmentSamples);
+        layerJobs[1].set(mSampler2, separateLayers ? layerOutput : buffer, midiMessages, segmentStart, segmentSamples);
+        
+        // El pool se saca del atómico mientras se usa: el hilo de mensajes no lo destruye hasta que vuelve
+        auto* pool = separateLayers && parallelLayers && segmentSamples >= minParallelSamples
+                         ? activeRenderPool.exchange(nullptr, std::memory_order_acquire) : nullptr;
+        
+        if (pool != nullptr)
+        {
+            pool->run(jobs, 2);
+            activeRenderPool.store(pool, std::memory_order_release);
+        }
+        else
+        {
+            layerJobs[0].run();
+            layerJobs[1].run();
+        }
+        
+        segmentStart += segmentSamples;
     }
+    
+    // Suma en orden fijo: capa 1 y después capa 2, haya renderizado cada una el hilo que sea
+    PROTECTEDSOUNDS_INSTRUMENT_STAGE(instrumentation, mixStage);
+    
+    if (separateLayers)
+        for (int channel = 0; channel < numLayerChannels; ++channel)
+            juce::FloatVectorOperations::add(buffer.getWritePointer(channel, startSample),
+                                             layerOutput.getReadPointer(channel, startSample), numSamples);
+}
 
-    // ========================================================================
-    // PROCESAMIENTO DE AUDIO - MEZCLA DE SAMPLERS
-    // ========================================================================
-    
-    // Obtener parámetro de mezcla (0-100%)
-    float mixAmount = *apvts.getRawParameterValue("MixAmount") / 100.0f;
-    
-    // Crear buffers separados para cada sampler
-    juce::AudioBuffer<float> clean1Buffer(buffer.getNumChannels(), buffer.getNumSamples());
-    juce::AudioBuffer<float> excited1Buffer(buffer.getNumChannels(), buffer.getNumSamples());
-    juce::AudioBuffer<float> clean2Buffer(buffer.getNumChannels(), buffer.getNumSamples());
-    juce::AudioBuffer<float> excited2Buffer(buffer.getNumChannels(), buffer.getNumSamples());
-    
-    clean1Buffer.clear();
-    excited1Buffer.clear();
-    clean2Buffer.clear();
-    excited2Buffer.clear();
-    
-    // Renderizar cada sampler por separado
-    mSampler1Clean.renderNextBlock(clean1Buffer, processedMidi, 0, buffer.getNumSamples());
-    mSampler1Excited.renderNextBlock(excited1Buffer, processedMidi, 0, buffer.getNumSamples());
-    mSampler2Clean.renderNextBlock(clean2Buffer, processedMidi, 0, buffer.getNumSamples());
-    mSampler2Excited.renderNextBlock(excited2Buffer, processedMidi, 0, buffer.getNumSamples());
-    
-    // Aplicar crossfading entre versiones clean y excited
-    clean1Buffer.applyGain(1.0f - mixAmount);
-    excited1Buffer.applyGain(mixAmount);
-    clean2Buffer.applyGain(1.0f - mixAmount);
-    excited2Buffer.applyGain(mixAmount);
-
-    // Mezclar todos los buffers en el buffer principal
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+void ProtectedSoundsAudioProcessor::updateRenderPool()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    
+    const bool wanted = parameters.parallelLayers->load() > 0.5f && juce::SystemStats::getNumCpus() > 1;
+    
+    if (wanted == (renderPool != nullptr))
+        return;
+    
+    if (wanted)
     {
-        buffer.addFrom(channel, 0, clean1Buffer, channel, 0, buffer.getNumSamples());
-        buffer.addFrom(channel, 0, excited1Buffer, channel, 0, buffer.getNumSamples());
-        buffer.addFrom(channel, 0, clean2Buffer, channel, 0, buffer.getNumSamples());
-        buffer.addFrom(channel, 0, excited2Buffer, channel, 0, buffer.getNumSamples());
+        renderPool = std::make_unique<RenderWorkerPool>(1);
+        activeRenderPool.store(renderPool.get(), std::memory_order_release);
+        return;
     }
+    
+    // Si el hilo de audio lo está usando, como mucho dura lo que tarda en renderizar un trozo
+    for (auto* expected = renderPool.get();
+         ! activeRenderPool.compare_exchange_weak(expected, nullptr, std::memory_order_acq_rel);
+         expected = renderPool.get())
+        juce::Thread::yield();
+    
+    renderPool.reset();
+}
 
-    // Aplicar limitador final
-    juce::dsp::AudioBlock<float> audioBlock(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(audioBlock);
-    limiter.process(context);
+void ProtectedSoundsAudioProcessor::applyOutputLevel(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    PROTECTEDSOUNDS_INSTRUMENT_STAGE(instrumentation, mixStage);
+    
+    // Una pasada vectorizada por canal: con rampa multiplica por la curva, si no por una constante
+    if (levelSmoother.isSmoothing())
+    {
+        auto* levels = rampBuffer.getWritePointer(levelRamp);
+        levelSmoother.fillRamp(levels, numSamples);
+        
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel, startSample), levels, numSamples);
+        
+        return;
+    }
+    
+    const auto level = levelSmoother.getCurrentValue();
+    
+    if (level != 1.0f)
+        buffer.applyGain(startSample, numSamples, level);
 }
 
 // ============================================================================
@@ -299,73 +446,144 @@ void ProtectedSoundsAudioProcessor::setStateInformation(const void* data, int si
 
 void ProtectedSoundsAudioProcessor::loadSoundPairForSelector1(const juce::String& soundName)
 {
-    auto [cleanStream, excitedStream] = soundsManager.loadSoundPair(soundName);
-    
-    if (cleanStream != nullptr && excitedStream != nullptr)
+    // Con los metadatos del catálogo la duración y los sliders de loop se preparan ya,
+    // sin esperar a que se decodifique nada
+    if (const auto* info = soundsManager->getSoundInfo(soundName); info != nullptr && info->hasMetadata())
     {
-        auto cleanReader = mFormatManager.createReaderFor(std::move(cleanStream));
-        auto excitedReader = mFormatManager.createReaderFor(std::move(excitedStream));
+        setDefaultLoop(info->getLengthInSeconds(),
+                       (double) info->loopStart / info->sampleRate,
+                       (double) (info->loopEnd > info->loopStart ? info->loopEnd : info->lengthInSamples) / info->sampleRate);
+        fileName = soundName;
+        updateEditorLoopSliders();
+    }
 
-        if (cleanReader != nullptr && excitedReader != nullptr)
-        {
-            // Almacenar información del audio
-            audioLength.store(cleanReader->lengthInSamples / cleanReader->sampleRate);
-            
-            // Crear waveform para visualización
-            waveForm.setSize(1, (int)cleanReader->lengthInSamples);
-            cleanReader->read(&waveForm, 0, (int)cleanReader->lengthInSamples, 0, true, false);
-            fileName = soundName;
-
-            // Configurar rango MIDI (todas las notas)
-            juce::BigInteger range;
-            range.setRange(0, 128, true);
-            
-            // Cargar samples en los samplers
-            mSampler1Clean.clearSounds();
-            mSampler1Excited.clearSounds();
-            
-            mSampler1Clean.addSound(new juce::SamplerSound(soundName + "_clean",
-                                                     *cleanReader, range, 60, 0.1, 0.1, 10.0));
-            mSampler1Excited.addSound(new juce::SamplerSound(soundName + "_excited",
-                                                     *excitedReader, range, 60, 0.1, 0.1, 10.0));
-            
-            updateADSR();
-            
-            // Configurar puntos de loop por defecto (todo el audio)
-            loopStartPosition.store(0);
-            loopEndPosition.store(static_cast<int64_t>(audioLength.load() * getSampleRate()));
-            
-            // Actualizar editor si existe
-            updateEditorLoopSliders();
-        }
+    // Sólo encola la carga: el ComboBox no espera a que se decodifique nada
+    sampleLoader.requestLoad(0, soundName);
+}
+
+void ProtectedSoundsAudioProcessor::setDefaultLoop(double lengthSeconds, double loopStartSeconds, double loopEndSeconds)
+{
+    audioLength.store(lengthSeconds);
+    
+    // Sin frecuencia todavía los samples saldrían 0: prepareToPlay los calcula de los segundos
+    if (getSampleRate() <= 0.0)
+    {
+        pendingLoopEndSeconds.store(loopEndSeconds);
+        pendingLoopStartSeconds.store(loopStartSeconds);
     }
+    
+    loopStartPosition.store(static_cast<int64_t>(loopStartSeconds * getSampleRate()));
+    loopEndPosition.store(static_cast<int64_t>(loopEndSeconds * getSampleRate()));
+    markParametersDirty(loopGroup);
 }
 
 void ProtectedSoundsAudioProcessor::loadSoundPairForSelector2(const juce::String& soundName)
 {
-    auto [cleanStream, excitedStream] = soundsManager.loadSoundPair(soundName);
+    sampleLoader.requestLoad(1, soundName);
+}
+
+void ProtectedSoundsAudioProcessor::loadSoundPairInBackground(int slot, const juce::String& soundName, bool isReload)
+{
+    // Se ejecuta en el hilo del cargador. Si esta u otra instancia ya cargó el sonido, sale de la caché.
+    // Los datos se convierten a la frecuencia del host, que forma parte de la clave: a otra
+    // frecuencia es otra entrada, y las viejas las acaba desalojando la caché cuando nadie las usa
+    const auto hostSampleRate = getSampleRate();
+    const auto format = hostSampleRate > 0.0 ? "dual-layer-f32x4@" + juce::String(juce::roundToInt(hostSampleRate))
+                                             : juce::String("dual-layer-f32x4");
+
+    auto sampleData = sampleCache->getOrLoad(soundName, format,
+                                             [manager = soundsManager, soundName, hostSampleRate]() -> DualLayerSampleData::Ptr
+    {
+        auto [cleanReader, excitedReader] = manager->openReaderPair(soundName);
+
+        if (cleanReader == nullptr || excitedReader == nullptr)
+            return nullptr;
+
+        // Un sonido que va entero a memoria se lee todo de todas formas: mejor descifrarlo de una
+        // vez repartido entre varios hilos que trozo a trozo a medida que se decodifica
+        if (DualLayerSampleData::isResident(*cleanReader, *excitedReader))
+        {
+            auto [cleanWhole, excitedWhole] = manager->openReaderPair(soundName, ProtectedSoundsManager::Decryption::whole);
+
+            if (cleanWhole != nullptr && excitedWhole != nullptr)
+            {
+                cleanReader = std::move(cleanWhole);
+                excitedReader = std::move(excitedWhole);
+            }
+        }
+
+        // Si el sonido es largo sólo se lee la cabeza y el streamer abre sus propios lectores para el resto.
+        // Los datos pueden sobrevivir a esta instancia, así que no guardan nada suyo.
+        return new DualLayerSampleData(soundName, *cleanReader, *excitedReader,
+                                       [manager, soundName] { return manager->openReaderPair(soundName); },
+                                       hostSampleRate);
+    });
+
+    if (sampleData == nullptr)
+        return;
     
-    if (cleanStream != nullptr && excitedStream != nullptr)
+    // El hilo de audio adopta los datos nuevos al principio del siguiente bloque; los picos
+    // de la forma de onda se calculan después para no retrasar el sonido
+    sampleStreamer.setStreamedSound(slot, sampleData->isStreamed());
+    (slot == 0 ? mSampler1 : mSampler2).publishSampleData(sampleData);
+
+    // Al recargar el mismo sonido (otra frecuencia del host) el loop ya está reescalado en
+    // prepareToPlay y la forma de onda no cambia: no se toca nada de lo que ve el editor
+    if (slot != 0 || isReload)
+        return;
+
+    // Sin metadatos en el catálogo, la duración y el loop por defecto (todo el audio) salen de los datos
+    const auto* info = soundsManager->getSoundInfo(soundName);
+    const bool needsMetadata = info == nullptr || ! info->hasMetadata();
+
+    if (needsMetadata)
     {
-        auto cleanReader = mFormatManager.createReaderFor(std::move(cleanStream));
-        auto excitedReader = mFormatManager.createReaderFor(std::move(excitedStream));
+        const double newAudioLength = sampleData->getLength() / sampleData->getSourceSampleRate();
+        setDefaultLoop(newAudioLength, 0.0, newAudioLength);
+    }
+
+    // Pirámide de picos de la versión clean: de los frames si están en memoria y si no leyendo por bloques
+    auto peaks = std::make_shared<WaveformPeaks>(sampleData->getLength());
 
-        if (cleanReader != nullptr && excitedReader != nullptr)
+    if (sampleData->isStreamed())
+    {
+        if (auto cleanReader = soundsManager->openReaderPair(soundName).first)
         {
-            juce::BigInteger range;
-            range.setRange(0, 128, true);
-            
-            mSampler2Clean.clearSounds();
-            mSampler2Excited.clearSounds();
-            
-            mSampler2Clean.addSound(new juce::SamplerSound(soundName + "_clean",
-                                                     *cleanReader, range, 60, 0.1, 0.1, 10.0));
-            mSampler2Excited.addSound(new juce::SamplerSound(soundName + "_excited",
-                                                     *excitedReader, range, 60, 0.1, 0.1, 10.0));
-            
-            updateADSR();
+            constexpr int blockSize = 65536;
+            juce::AudioBuffer<float> block(2, blockSize);
+
+            for (juce::int64 position = 0; position < sampleData->getLength(); position += blockSize)
+            {
+                const auto numFrames = (int) juce::jmin((juce::int64) blockSize, sampleData->getLength() - position);
+                cleanReader->read(&block, 0, numFrames, position, true, true);
+                peaks->addFrames(block.getReadPointer(0), block.getReadPointer(1), numFrames);
+            }
         }
     }
+    else
+    {
+        const float* frames = sampleData->getFrameData();
+        peaks->addFrames(frames, frames + 2, sampleData->getLength(), DualLayerSampleData::numLanes);
+    }
+
+    peaks->finish();
+
+    // El editor sólo se toca desde el hilo de mensajes
+    juce::MessageManager::callAsync([weakThis = juce::WeakReference<ProtectedSoundsAudioProcessor>(this),
+                                     peaks = std::shared_ptr<const WaveformPeaks>(std::move(peaks)),
+                                     soundName, needsMetadata]
+    {
+        if (auto* processor = weakThis.get())
+        {
+            processor->waveformPeaks = peaks;
+            processor->fileName = soundName;
+
+            if (needsMetadata)
+                processor->updateEditorLoopSliders();
+            else if (auto* editor = dynamic_cast<ProtectedSoundsAudioProcessorEditor*>(processor->getActiveEditor()))
+                editor->refreshWaveform();
+        }
+    });
 }
 
 // ============================================================================
@@ -386,59 +604,109 @@ void ProtectedSoundsAudioProcessor::setLoopPoints(int64_t startSamples, int64_t
     
     loopStartPosition.store(startSamples);
     loopEndPosition.store(endSamples);
+    markParametersDirty(loopGroup);
 }
 
 // ============================================================================
 // ACTUALIZACIÓN DE PARÁMETROS
 // ============================================================================
 
-void ProtectedSoundsAudioProcessor::updateADSR()
+void ProtectedSoundsAudioProcessor::addParameterGroup(juce::uint32 group, std::initializer_list<const char*> parameterIDs)
 {
-    // Actualizar parámetros ADSR para ambos grupos
-    mADSRParams.attack = apvts.getRawParameterValue("Attack")->load();
-    mADSRParams2.attack = apvts.getRawParameterValue("Attack2")->load();
-    mADSRParams.decay = apvts.getRawParameterValue("Decay")->load();
-    mADSRParams2.decay = apvts.getRawParameterValue("Decay2")->load();
-    mADSRParams.sustain = apvts.getRawParameterValue("Sustain")->load();
-    mADSRParams2.sustain = apvts.getRawParameterValue("Sustain2")->load();
-    mADSRParams.release = apvts.getRawParameterValue("Release")->load();
-    mADSRParams2.release = apvts.getRawParameterValue("Release2")->load();
-
-    // Aplicar a todos los sounds del primer grupo
-    for (int i = 0; i < mSampler1Clean.getNumSounds(); ++i)
+    for (auto* parameterID : parameterIDs)
+    {
+        auto* listener = parameterListeners.add(new ParameterGroupListener(dirtyParameterGroups, group));
+        listenedParameterIDs.add(parameterID);
+        apvts.addParameterListener(parameterID, listener);
+    }
+}
+
+void ProtectedSoundsAudioProcessor::applyParameterChanges(juce::uint32 groups) noexcept
+{
+    // ADSR de cada grupo; las voces los toman al empezar la siguiente nota
+    if (groups & envelope1Group)
+    {
+        mADSRParams = { parameters.attack[0]->load(), parameters.decay[0]->load(),
+                        parameters.sustain[0]->load(), parameters.release[0]->load() };
+        mSampler1.setEnvelopeParameters(mADSRParams);
+    }
+    
+    if (groups & envelope2Group)
     {
-        if (auto sound = dynamic_cast<juce::SamplerSound*>(mSampler1Clean.getSound(i).get()))
-            sound->setEnvelopeParameters(mADSRParams);
+        mADSRParams2 = { parameters.attack[1]->load(), parameters.decay[1]->load(),
+                         parameters.sustain[1]->load(), parameters.release[1]->load() };
+        mSampler2.setEnvelopeParameters(mADSRParams2);
     }
-    for (int i = 0; i < mSampler1Excited.getNumSounds(); ++i)
+    
+    // Loop: cada voz hace el salto en el sample exacto. Los puntos se guardan en samples del
+    // host; las voces los reciben en segundos
+    if (groups & loopGroup)
     {
-        if (auto sound = dynamic_cast<juce::SamplerSound*>(mSampler1Excited.getSound(i).get()))
-            sound->setEnvelopeParameters(mADSRParams);
+        const double hostSampleRate = getSampleRate();
+        const double loopStartSeconds = loopStartPosition.load() / hostSampleRate;
+        const double loopEndSeconds = loopEndPosition.load() / hostSampleRate;
+        const double loopCrossfadeSeconds = parameters.loopCrossfade->load() / 1000.0;
+        
+        mSampler1.setLoop(loopEnabled.load(), loopStartSeconds, loopEndSeconds, loopCrossfadeSeconds);
+        mSampler2.setLoop(loopEnabled.load(), loopStartSeconds, loopEndSeconds, loopCrossfadeSeconds);
     }
     
-    // Aplicar a todos los sounds del segundo grupo
-    for (int i = 0; i < mSampler2Clean.getNumSounds(); ++i)
+    // Filtro por voz, con el corte suavizado y modulado por envolvente y velocity
+    if (groups & filterGroup)
     {
-        if (auto sound = dynamic_cast<juce::SamplerSound*>(mSampler2Clean.getSound(i).get()))
-            sound->setEnvelopeParameters(mADSRParams2);
+        const bool filterEnabled = parameters.filterEnabled->load() > 0.5f;
+        const auto filterType = (VoiceFilter::Type) juce::roundToInt(parameters.filterType->load());
+        const auto filterCutoff = parameters.filterFreq->load();
+        const auto filterResonance = parameters.filterRes->load();
+        const auto filterEnvelopeOctaves = parameters.filterEnvAmount->load();
+        const auto filterVelocityOctaves = parameters.filterVelAmount->load();
+        
+        mSampler1.setFilter(filterEnabled, filterType, filterCutoff, filterResonance, filterEnvelopeOctaves, filterVelocityOctaves);
+        mSampler2.setFilter(filterEnabled, filterType, filterCutoff, filterResonance, filterEnvelopeOctaves, filterVelocityOctaves);
     }
-    for (int i = 0; i < mSampler2Excited.getNumSounds(); ++i)
+    
+    // Mezcla (0-100%) y nivel de salida: el valor nuevo es el objetivo de la rampa
+    if (groups & mixLevelGroup)
     {
-        if (auto sound = dynamic_cast<juce::SamplerSound*>(mSampler2Excited.getSound(i).get()))
-            sound->setEnvelopeParameters(mADSRParams2);
+        mixSmoother.setTargetValue(parameters.mixAmount->load() / 100.0f);
+        levelSmoother.setTargetValue(juce::Decibels::decibelsToGain(parameters.outputLevel->load()));
     }
+    
+    // Calidad de la interpolación para las notas que empiecen a partir de ahora
+    if (groups & interpolationGroup)
+    {
+        const auto mode = (SampleInterpolator::Mode) juce::roundToInt(parameters.interpolation->load());
+        mSampler1.setInterpolationMode(mode);
+        mSampler2.setInterpolationMode(mode);
+    }
+    
+    // Polifonía y robo de voces: afectan a la asignación de las notas siguientes
+    if (groups & voicePoolGroup)
+    {
+        const auto polyphony = juce::roundToInt(parameters.polyphony->load());
+        const auto policy = (DualLayerSynthesiser::StealingPolicy) juce::roundToInt(parameters.voiceStealing->load());
+        
+        mSampler1.setPolyphony(polyphony);
+        mSampler2.setPolyphony(polyphony);
+        mSampler1.setStealingPolicy(policy);
+        mSampler2.setStealingPolicy(policy);
+    }
+    
+    if (groups & renderGroup)
+        parallelLayers = parameters.parallelLayers->load() > 0.5f;
 }
 
+// El filtro es del hilo de audio: desde fuera sólo se cambian los parámetros
 void ProtectedSoundsAudioProcessor::setFilterFrequency(float frequency)
 {
-    filterFrequency = frequency;
-    filter.setCutoffFrequency(filterFrequency);
+    if (auto* parameter = apvts.getParameter("FilterFreq"))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(frequency));
 }
 
 void ProtectedSoundsAudioProcessor::setFilterResonance(float resonance)
 {
-    filterResonance = resonance;
-    filter.setResonance(filterResonance);
+    if (auto* parameter = apvts.getParameter("FilterRes"))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(resonance));
 }
 
 // ============================================================================
@@ -447,7 +715,7 @@ void ProtectedSoundsAudioProcessor::setFilterResonance(float resonance)
 
 juce::StringArray ProtectedSoundsAudioProcessor::getAvailableSounds() const
 {
-    return soundsManager.getAvailableSounds();
+    return soundsManager->getAvailableSounds();
 }
 
 void ProtectedSoundsAudioProcessor::updateEditorLoopSliders()
@@ -456,8 +724,18 @@ void ProtectedSoundsAudioProcessor::updateEditorLoopSliders()
     {
         editor->loopStartSlider.setRange(0.0, audioLength.load() * 1000.0, 1.0);
         editor->loopEndSlider.setRange(0.0, audioLength.load() * 1000.0, 1.0);
-        editor->loopEndSlider.setValue(audioLength.load() * 1000.0, juce::dontSendNotification);
-        editor->repaint();
+
+        // Loop por defecto del sonido (del catálogo, o todo el audio)
+        if (getSampleRate() > 0.0)
+        {
+            editor->loopStartSlider.setValue(loopStartPosition.load() * 1000.0 / getSampleRate(), juce::dontSendNotification);
+            editor->loopEndSlider.setValue(loopEndPosition.load() * 1000.0 / getSampleRate(), juce::dontSendNotification);
+        }
+        else
+        {
+            editor->loopEndSlider.setValue(audioLength.load() * 1000.0, juce::dontSendNotification);
+        }
+        editor->refreshWaveform();
     }
 }
 
@@ -492,6 +770,64 @@ juce::AudioProcessorValueTreeState::ParameterLayout ProtectedSoundsAudioProcesso
         "Filter Resonance",
         juce::NormalisableRange<float>(0.1f, 1.0f, 0.01f),
         0.7f));
+    parameters.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("FilterEnabled", 1),
+        "Filter",
+        false));
+    parameters.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("FilterType", 1),
+        "Filter Type",
+        juce::StringArray { "Lowpass", "Bandpass", "Highpass" }, // mismo orden que VoiceFilter::Type
+        0));
+    parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("FilterEnvAmount", 1),
+        "Filter Env Amount",
+        juce::NormalisableRange<float>(-4.0f, 4.0f, 0.01f),
+        0.0f)); // octavas con la envolvente al máximo
+    parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("FilterVelAmount", 1),
+        "Filter Vel Amount",
+        juce::NormalisableRange<float>(0.0f, 4.0f, 0.01f),
+        0.0f)); // octavas con velocity máxima
+    
+    // Crossfade en la costura del loop (0 = salto directo)
+    parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("LoopCrossfade", 1),
+        "Loop Crossfade",
+        juce::NormalisableRange<float>(0.0f, 1000.0f, 1.0f, 0.5f),
+        0.0f));
+    
+    // Calidad de la transposición: coste por voz de menos a más
+    parameters.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("Interpolation", 1),
+        "Interpolation",
+        juce::StringArray { "Linear", "Hermite", "Sinc" }, // mismo orden que SampleInterpolator::Mode
+        1));
+    
+    // Notas a la vez por capa y qué voz se roba cuando no quedan libres
+    parameters.push_back(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("Polyphony", 1),
+        "Polyphony",
+        1, maxVoicesPerLayer, 16));
+    parameters.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("VoiceStealing", 1),
+        "Voice Stealing",
+        juce::StringArray { "Oldest", "Quietest", "Same Note" }, // mismo orden que DualLayerSynthesiser::StealingPolicy
+        0));
+    
+    // Reparte el render de las dos capas entre el hilo de audio y un worker; el resultado es
+    // el mismo que en serie
+    parameters.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("ParallelLayers", 1),
+        "Parallel Layers",
+        false));
+    
+    // Nivel de salida antes del limitador
+    parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("OutputLevel", 1),
+        "Level",
+        juce::NormalisableRange<float>(-48.0f, 6.0f, 0.1f, 2.0f),
+        0.0f));
     
     // Parámetro de mezcla
     parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
@@ -505,12 +841,6 @@ juce::AudioProcessorValueTreeState::ParameterLayout ProtectedSoundsAudioProcesso
     return { parameters.begin(), parameters.end() };
 }
 
-void ProtectedSoundsAudioProcessor::valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged,
-                                                          const juce::Identifier& property)
-{
-    sUpdate = true;
-}
-
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new ProtectedSoundsAudioProcessor();
@@ -1,9 +1,16 @@
 #pragma once
 #include <JuceHeader.h>
 #include "ProtectedSoundsManager.h"
+#include "DualLayerSampler.h"
+#include "SampleLoader.h"
+#include "SampleCache.h"
+#include "WaveformPeaks.h"
+#include "AudioTelemetry.h"
+#include "ParameterSmoothing.h"
+#include "RenderWorkerPool.h"
+#include "ProcessingInstrumentation.h"
 
-class ProtectedSoundsAudioProcessor : public juce::AudioProcessor,
-                                    public juce::ValueTree::Listener
+class ProtectedSoundsAudioProcessor : public juce::AudioProcessor
 {
 public:
     ProtectedSoundsAudioProcessor();
@@ -11,6 +18,7 @@ public:
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void reset() override;
 
 #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
@@ -43,12 +51,18 @@ public:
     void loadSoundPairForSelector1(const juce::String& soundName);
     void loadSoundPairForSelector2(const juce::String& soundName);
     juce::StringArray getAvailableSounds() const;
-    void updateADSR();
+    
+    // Render offline: espera a que el cargador termine las peticiones de sonidos encoladas
+    bool waitForSoundLoads(int timeoutMs) { return sampleLoader.waitUntilIdle(timeoutMs); }
+    
+    // Hilo de mensajes: crea o destruye el pool de render según ParallelLayers. Se llama solo
+    // cuando cambia el parámetro; las herramientas sin bucle de mensajes lo llaman ellas
+    void updateRenderPool();
     
     juce::ADSR::Parameters& getADSRParams() { return mADSRParams; }
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
     //loop
-    void setLoopEnabled(bool shouldLoop) { loopEnabled.store(shouldLoop); }
+    void setLoopEnabled(bool shouldLoop) { loopEnabled.store(shouldLoop); markParametersDirty(loopGroup); }
     bool isLooping() const { return loopEnabled.load(); }
     double getAudioLength() const { return audioLength.load(); }
     void setLoopPoints(int64_t startSamples, int64_t endSamples);
@@ -58,29 +72,50 @@ public:
     //filtro
     void setFilterFrequency(float frequency);
     void setFilterResonance(float resonance);
-    float getFilterFrequency() const { return filterFrequency; }
+    float getFilterFrequency() const { return parameters.filterFreq->load(); }
     
-    juce::AudioBuffer<float>& getWaveForm() { return waveForm; }
+    // Hilo de mensajes: picos del sonido del selector 1 (nullptr hasta que se calculan)
+    std::shared_ptr<const WaveformPeaks> getWaveformPeaks() const { return waveformPeaks; }
     const juce::String& getFileName() const { return fileName; }
-    void setWaveForm(const juce::AudioBuffer<float>& newWaveForm) { waveForm = newWaveForm; }
     void setFileName(const juce::String& name) { fileName = name; }
     void updateEditorLoopSliders();
 
+    // Hilo de mensajes: estado de las voces que publica processBlock una vez por bloque
+    bool pullTelemetry(TelemetryFrame& dest) noexcept { return telemetry.pullLatest(dest); }
+
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    // Hilo de mensajes: carga de CPU de processBlock por etapas (medidor y volcado del editor)
+    ProcessingInstrumentation& getInstrumentation() noexcept { return instrumentation; }
+   #endif
+
 
 private:
-    juce::Synthesiser mSampler1;
-    juce::Synthesiser mSampler2;
-    // En la sección private:
-    juce::Synthesiser mSampler1Clean;
-    juce::Synthesiser mSampler1Excited;
-    juce::Synthesiser mSampler2Clean;
-    juce::Synthesiser mSampler2Excited;
-    const int mNumVoices { 3 };
+    // Compartidos por todas las instancias del proceso. El gestor va el primero: los streams de
+    // las voces leen del paquete mapeado que tiene abierto y tienen que destruirse antes
+    juce::SharedResourcePointer<ProtectedSoundsManager> soundsManager;
+    juce::SharedResourcePointer<SampleCache> sampleCache;
+
+    // Precarga de los sonidos largos; va antes que los samplers porque sus voces se registran en él
+    SampleStreamer sampleStreamer;
+
+    // Cada sampler reproduce la pareja clean/excited con una sola voz por nota. Las voces se
+    // crean todas aquí; el parámetro Polyphony decide cuántas se usan
+    static constexpr int maxVoicesPerLayer { 32 };
+    DualLayerSynthesiser mSampler1 { maxVoicesPerLayer, sampleStreamer };
+    DualLayerSynthesiser mSampler2 { maxVoicesPerLayer, sampleStreamer };
     
     juce::dsp::Limiter<float> limiter;
     juce::ADSR::Parameters mADSRParams;
     juce::ADSR::Parameters mADSRParams2;
-    juce::AudioBuffer<float> tempBuffer;
+    
+    // Tamaño máximo de trozo que se renderiza de una vez (fijado en prepareToPlay)
+    int maxBlockSize { 0 };
+    
+    // En render offline el streamer puede ir por detrás: cada trozo espera a que llene los rings
+    static constexpr int offlineStreamTimeoutMs = 5000;
+    
+    // Frecuencia del último prepareToPlay; los sonidos en memoria se cargan convertidos a ella
+    double preparedSampleRate { 0.0 };
     
     juce::AudioFormatManager mFormatManager;
     juce::AudioFormatManager mFormatManager2;
@@ -89,12 +124,63 @@ private:
     
     juce::AudioProcessorValueTreeState apvts;
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
-    void valueTreePropertyChanged(juce::ValueTree& treeWhosePropertyHasChanged,
-                                const juce::Identifier& property) override;
     
-    std::atomic<bool> sUpdate { false };
-    std::atomic<bool> isNotePlaying { false };
-    std::atomic<int> currentNoteNumber { -1 };
+    // Grupos de parámetros. Los listeners sólo marcan el bit de su grupo (pueden llamarse desde
+    // cualquier hilo, también el de audio) y processBlock aplica los grupos marcados: si no ha
+    // cambiado nada no se toca ningún parámetro
+    enum ParameterGroup : juce::uint32
+    {
+        envelope1Group = 1 << 0,
+        envelope2Group = 1 << 1,
+        filterGroup    = 1 << 2,
+        loopGroup      = 1 << 3,
+        mixLevelGroup  = 1 << 4,
+        interpolationGroup = 1 << 5,
+        voicePoolGroup = 1 << 6,
+        renderGroup    = 1 << 7,
+        allParameterGroups = (1 << 8) - 1
+    };
+    
+    struct ParameterGroupListener : public juce::AudioProcessorValueTreeState::Listener
+    {
+        ParameterGroupListener(std::atomic<juce::uint32>& flags, juce::uint32 groupBit) : dirtyFlags(flags), group(groupBit) {}
+        void parameterChanged(const juce::String&, float) override { dirtyFlags.fetch_or(group, std::memory_order_release); }
+        
+        std::atomic<juce::uint32>& dirtyFlags;
+        const juce::uint32 group;
+    };
+    
+    // Punteros a los valores, resueltos una vez en el constructor
+    struct ParameterPointers
+    {
+        std::atomic<float>* attack[2] {};
+        std::atomic<float>* decay[2] {};
+        std::atomic<float>* sustain[2] {};
+        std::atomic<float>* release[2] {};
+        std::atomic<float>* filterEnabled { nullptr };
+        std::atomic<float>* filterType { nullptr };
+        std::atomic<float>* filterFreq { nullptr };
+        std::atomic<float>* filterRes { nullptr };
+        std::atomic<float>* filterEnvAmount { nullptr };
+        std::atomic<float>* filterVelAmount { nullptr };
+        std::atomic<float>* loopCrossfade { nullptr };
+        std::atomic<float>* mixAmount { nullptr };
+        std::atomic<float>* outputLevel { nullptr };
+        std::atomic<float>* interpolation { nullptr };
+        std::atomic<float>* polyphony { nullptr };
+        std::atomic<float>* voiceStealing { nullptr };
+        std::atomic<float>* parallelLayers { nullptr };
+    };
+    
+    void markParametersDirty(juce::uint32 groups) noexcept { dirtyParameterGroups.fetch_or(groups, std::memory_order_release); }
+    void addParameterGroup(juce::uint32 group, std::initializer_list<const char*> parameterIDs);
+    void applyParameterChanges(juce::uint32 groups) noexcept;
+    
+    ParameterPointers parameters;
+    std::atomic<juce::uint32> dirtyParameterGroups { allParameterGroups };
+    juce::OwnedArray<ParameterGroupListener> parameterListeners;
+    juce::StringArray listenedParameterIDs;
+    
     std::atomic<bool> loopEnabled { false };
     std::atomic<double> audioLength { 0.0 };
     //std::atomic<double> loopStartPosition { 0.0 };
@@ -102,19 +188,106 @@ private:
     //double currentPosition = 0.0;
     std::atomic<int64_t> loopStartPosition{0};  // en samples
     std::atomic<int64_t> loopEndPosition{0};    // en samples
-    std::atomic<int64_t> currentSamplePosition{0}; // en samples
     
-    ProtectedSoundsManager soundsManager;
+    // Loop por defecto fijado antes del primer prepareToPlay, en segundos (-1 si no hay)
+    std::atomic<double> pendingLoopStartSeconds { -1.0 };
+    std::atomic<double> pendingLoopEndSeconds { -1.0 };
     
-    juce::dsp::StateVariableTPTFilter<float> filter;
-    float filterFrequency = 1000.0f;
-    float filterResonance = 0.7f;
     
     float mixAmount = 0.5f;
 
+    // Rampas de MixAmount y OutputLevel: un cambio de valor se reparte en parameterRampSeconds
+    // en vez de aplicarse de golpe al principio del bloque
+    static constexpr double parameterRampSeconds = 0.02;
+    enum RampChannel { mixRamp, cleanGainRamp, excitedGainRamp, levelRamp, numRampChannels };
+    SmoothedParameter mixSmoother;
+    SmoothedParameter levelSmoother;
+    juce::AudioBuffer<float> rampBuffer; // reservado en prepareToPlay
+    void renderSamplers(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, int startSample, int numSamples);
+
+    // Render de las capas en paralelo (opcional). En los dos modos el sampler 2 renderiza en
+    // layerBuffer y se suma a la salida después del sampler 1, así el resultado es idéntico
+    // bit a bit. Los trozos cortos no compensan el reparto y se renderizan en serie
+    struct LayerRenderJob : public RenderJob
+    {
+        void set(DualLayerSynthesiser& samplerToRender, juce::AudioBuffer<float>& destination,
+                 const juce::MidiBuffer& midiMessages, int firstSample, int numSamplesToRender) noexcept
+        {
+            sampler = &samplerToRender;
+            output = &destination;
+            midi = &midiMessages;
+            startSample = firstSample;
+            numSamples = numSamplesToRender;
+        }
+        
+        void run() noexcept override
+        {
+            PROTECTEDSOUNDS_INSTRUMENT_CYCLES(*cycles);
+            sampler->renderNextBlock(*output, *midi, startSample, numSamples);
+        }
+        
+
+        DualLayerSynthesiser* sampler = nullptr;
+        juce::AudioBuffer<float>* output = nullptr;
+        const juce::MidiBuffer* midi = nullptr;
+        int startSample = 0;
+        int numSamples = 0;
+        
+       #if PROTECTEDSOUNDS_INSTRUMENTATION
+        juce::uint64* cycles = nullptr; // etapa del sampler en la instrumentación
+       #endif
+    };
+
+    static constexpr int minParallelSamples = 64;
+    juce::AudioBuffer<float> layerBuffer; // reservado en prepareToPlay
+    
+    // El pool (un hilo de tiempo real fijado a un núcleo) sólo existe con ParallelLayers activo.
+    // Lo crea y lo destruye el hilo de mensajes; el hilo de audio lo saca de activeRenderPool
+    // mientras renderiza y lo devuelve después, así que para destruirlo basta con esperar a que
+    // vuelva a estar ahí
+    std::unique_ptr<RenderWorkerPool> renderPool;
+    std::atomic<RenderWorkerPool*> activeRenderPool { nullptr };
+    
+    struct RenderPoolListener : public juce::AudioProcessorValueTreeState::Listener,
+                                private juce::AsyncUpdater
+    {
+        explicit RenderPoolListener(ProtectedSoundsAudioProcessor& p) : processor(p) {}
+        ~RenderPoolListener() override { cancelPendingUpdate(); }
+        
+        // Puede llegar desde cualquier hilo; el pool siempre se toca en el de mensajes
+        void parameterChanged(const juce::String&, float) override { triggerAsyncUpdate(); }
+        void handleAsyncUpdate() override { processor.updateRenderPool(); }
+        
+        ProtectedSoundsAudioProcessor& processor;
+    };
+    
+    RenderPoolListener renderPoolListener { *this };
+    bool parallelLayers { false };
+    void applyOutputLevel(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
     //waveform
-    juce::AudioBuffer<float> waveForm;
+    std::shared_ptr<const WaveformPeaks> waveformPeaks;
     juce::String fileName;
+
+    // Playheads y envolventes para el editor; processBlock escribe sin locks ni memoria nueva
+    TelemetryChannel telemetry;
+    
+   #if PROTECTEDSOUNDS_INSTRUMENTATION
+    ProcessingInstrumentation instrumentation;
+   #endif
+    
+    JUCE_DECLARE_WEAK_REFERENCEABLE(ProtectedSoundsAudioProcessor)
+    
+    // Carga de sonidos en segundo plano; va al final para destruirse antes que los samplers
+    void loadSoundPairInBackground(int slot, const juce::String& soundName, bool isReload);
+    void setDefaultLoop(double lengthSeconds, double loopStartSeconds, double loopEndSeconds);
+    SampleLoader sampleLoader { [this](int slot, const juce::String& soundName, bool isReload) { loadSoundPairInBackground(slot, soundName, isReload); },
+                                [this]
+                                {
+                                    const juce::ScopedLock sl(sampleStreamer.getLifetimeLock());
+                                    mSampler1.collectGarbage();
+                                    mSampler2.collectGarbage();
+                                } };
     
 
     
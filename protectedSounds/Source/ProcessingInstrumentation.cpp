@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    ProcessingInstrumentation.cpp
+    Created: 18 Oct 2026 9:14:26pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "ProcessingInstrumentation.h"
+
+#if PROTECTEDSOUNDS_INSTRUMENTATION
+
+// ============================================================================
+// CycleCounter
+// ============================================================================
+
+double CycleCounter::getFrequency()
+{
+   #if JUCE_INTEL
+    // El TSC de las CPU actuales va a frecuencia constante: se calibra una vez contra el reloj
+    // de alta resolución y vale para todo el proceso
+    static const double frequency = []
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        const auto startCycles = now();
+
+        juce::Thread::sleep(20);
+
+        const auto endCycles = now();
+        const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+        return seconds > 0.0 ? (double) (endCycles - startCycles) / seconds : 1.0e9;
+    }();
+
+    return frequency;
+   #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+    juce::uint64 frequency;
+    asm volatile ("mrs %0, cntfrq_el0" : "=r" (frequency));
+    return (double) frequency;
+   #else
+    return (double) juce::Time::getHighResolutionTicksPerSecond();
+   #endif
+}
+
+// ============================================================================
+// Hilo de audio
+// ============================================================================
+
+void ProcessingInstrumentation::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    cyclesPerSample = newSampleRate > 0.0 ? CycleCounter::getFrequency() / newSampleRate : 0.0;
+
+    currentCycles.fill(0);
+    blockStart = previousBlockStart = previousBudgetCycles = 0;
+
+    for (auto& stage : stages)
+    {
+        for (auto& bucket : stage.histogram)
+            bucket.store(0, std::memory_order_relaxed);
+
+        stage.totalCycles.store(0, std::memory_order_relaxed);
+        stage.maxCycles.store(0, std::memory_order_relaxed);
+    }
+
+    numBlocks.store(0, std::memory_order_relaxed);
+    totalBudgetCycles.store(0, std::memory_order_relaxed);
+    deadlineMisses.store(0, std::memory_order_relaxed);
+    lateCallbacks.store(0, std::memory_order_relaxed);
+    peakLoad.store(0.0f, std::memory_order_relaxed);
+}
+
+ProcessingInstrumentation::ScopedBlock::ScopedBlock(ProcessingInstrumentation& owner, int samples, bool isRealtime) noexcept
+    : instrumentation(owner), numSamples(samples), realtime(isRealtime)
+{
+    instrumentation.currentCycles.fill(0);
+    instrumentation.blockStart = CycleCounter::now();
+}
+
+ProcessingInstrumentation::ScopedBlock::~ScopedBlock() noexcept
+{
+    instrumentation.endBlock(CycleCounter::now() - instrumentation.blockStart, numSamples, realtime);
+}
+
+void ProcessingInstrumentation::moveCycles(Stage from, Stage to, juce::uint64 cycles) noexcept
+{
+    auto& source = currentCycles[(size_t) from];
+    cycles = juce::jmin(cycles, source);
+
+    source -= cycles;
+    currentCycles[(size_t) to] += cycles;
+}
+
+void ProcessingInstrumentation::endBlock(juce::uint64 blockCycles, int numSamples, bool realtime) noexcept
+{
+    if (cyclesPerSample <= 0.0 || numSamples <= 0)
+        return;
+
+    currentCycles[blockStage] = blockCycles;
+
+    const auto budgetCycles = juce::jmax((juce::uint64) 1, (juce::uint64) (cyclesPerSample * numSamples));
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        auto& stage = stages[(size_t) i];
+        const auto cycles = currentCycles[(size_t) i];
+        const auto bucket = juce::jmin(numBuckets - 1, (int) ((double) cycles / (double) budgetCycles / bucketWidth));
+
+        increment(stage.histogram[(size_t) bucket]);
+        increment(stage.totalCycles, cycles);
+
+        if (cycles > stage.maxCycles.load(std::memory_order_relaxed))
+            stage.maxCycles.store(cycles, std::memory_order_relaxed);
+    }
+
+    increment(numBlocks);
+    increment(totalBudgetCycles, budgetCycles);
+
+    // El editor pone el pico a cero cuando lo lee: aquí hace falta compare-exchange
+    const auto load = (float) ((double) blockCycles / (double) budgetCycles);
+    auto peak = peakLoad.load(std::memory_order_relaxed);
+
+    while (load > peak && ! peakLoad.compare_exchange_weak(peak, load, std::memory_order_relaxed))
+    {
+    }
+
+    if (realtime)
+    {
+        if (blockCycles > budgetCycles)
+            increment(deadlineMisses);
+
+        if (previousBlockStart != 0
+            && (double) (blockStart - previousBlockStart) > lateCallbackRatio * (double) previousBudgetCycles)
+            increment(lateCallbacks);
+    }
+
+    previousBlockStart = realtime ? blockStart : 0;
+    previousBudgetCycles = budgetCycles;
+}
+
+// ============================================================================
+// Hilo de mensajes
+// ============================================================================
+
+float ProcessingInstrumentation::getAverageLoad(LoadReading& previous) const noexcept
+{
+    const LoadReading current { stages[blockStage].totalCycles.load(std::memory_order_relaxed),
+                                totalBudgetCycles.load(std::memory_order_relaxed) };
+
+    // Después de un prepareToPlay los contadores vuelven a empezar
+    if (current.cycles < previous.cycles || current.budgetCycles < previous.budgetCycles)
+        previous = {};
+
+    const auto cycles = current.cycles - previous.cycles;
+    const auto budgetCycles = current.budgetCycles - previous.budgetCycles;
+    previous = current;
+
+    return budgetCycles > 0 ? (float) ((double) cycles / (double) budgetCycles) : 0.0f;
+}
+
+juce::String ProcessingInstrumentation::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+        case midiStage:     return "midi";
+        case sampler1Stage: return "sampler1";
+        case sampler2Stage: return "sampler2";
+        case mixStage:      return "mix";
+        case limiterStage:  return "limiter";
+        case blockStage:    return "block";
+        case numStages:     break;
+    }
+
+    return {};
+}
+
+juce::String ProcessingInstrumentation::createReport() const
+{
+    const auto frequency = CycleCounter::getFrequency();
+    const auto budgetCycles = (double) totalBudgetCycles.load(std::memory_order_relaxed);
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("sampleRate", sampleRate);
+    report->setProperty("counterFrequency", frequency);
+    report->setProperty("blocks", (juce::int64) numBlocks.load(std::memory_order_relaxed));
+    report->setProperty("deadlineMisses", (juce::int64) deadlineMisses.load(std::memory_order_relaxed));
+    report->setProperty("lateCallbacks", (juce::int64) lateCallbacks.load(std::memory_order_relaxed));
+    report->setProperty("bucketWidth", bucketWidth);
+
+    auto* stageReports = new juce::DynamicObject();
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        const auto& stage = stages[(size_t) i];
+
+        // Copia del histograma; el audio puede seguir escribiendo mientras tanto
+        std::array<juce::uint32, numBuckets> counts;
+        juce::uint64 numCounted = 0;
+        int lastUsedBucket = -1;
+
+        for (int b = 0; b < numBuckets; ++b)
+        {
+            counts[(size_t) b] = stage.histogram[(size_t) b].load(std::memory_order_relaxed);
+            numCounted += counts[(size_t) b];
+
+            if (counts[(size_t) b] != 0)
+                lastUsedBucket = b;
+        }
+
+        // Borde superior del tramo en el que cae el percentil (el último tramo no tiene borde)
+        auto percentile = [&](double fraction)
+        {
+            const auto target = (juce::uint64) std::ceil(fraction * (double) numCounted);
+            juce::uint64 cumulative = 0;
+
+            for (int b = 0; b < numBuckets; ++b)
+            {
+                cumulative += counts[(size_t) b];
+
+                if (cumulative >= target && cumulative > 0)
+                    return juce::jmin(numBuckets - 1, b + 1) * bucketWidth;
+            }
+
+            return 0.0;
+        };
+
+        juce::Array<juce::var> histogram;
+
+        for (int b = 0; b <= lastUsedBucket; ++b)
+            histogram.add((juce::int64) counts[(size_t) b]);
+
+        const auto totalCycles = (double) stage.totalCycles.load(std::memory_order_relaxed);
+
+        auto* stageReport = new juce::DynamicObject();
+        stageReport->setProperty("meanLoad", budgetCycles > 0.0 ? totalCycles / budgetCycles : 0.0);
+        stageReport->setProperty("p50Load", percentile(0.5));
+        stageReport->setProperty("p99Load", percentile(0.99));
+        stageReport->setProperty("p999Load", percentile(0.999));
+        stageReport->setProperty("maxMicroseconds", (double) stage.maxCycles.load(std::memory_order_relaxed) * 1.0e6 / frequency);
+        stageReport->setProperty("totalSeconds", totalCycles / frequency);
+        stageReport->setProperty("histogram", histogram);
+
+        stageReports->setProperty(getStageName((Stage) i), juce::var(stageReport));
+    }
+
+    report->setProperty("stages", juce::var(stageReports));
+
+    return juce::JSON::toString(juce::var(report));
+}
+
+#endif
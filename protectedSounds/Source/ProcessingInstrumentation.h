@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    ProcessingInstrumentation.h
+    Created: 18 Oct 2026 9:14:26pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Medición del coste de processBlock por etapas. Sólo existe con PROTECTEDSOUNDS_INSTRUMENTATION
+// a 1 (por defecto en Debug); en Release los macros no generan código y la clase no se compila.
+// Para medir un Release basta con definir PROTECTEDSOUNDS_INSTRUMENTATION=1 en el proyecto.
+#ifndef PROTECTEDSOUNDS_INSTRUMENTATION
+ #if JUCE_DEBUG
+  #define PROTECTEDSOUNDS_INSTRUMENTATION 1
+ #else
+  #define PROTECTEDSOUNDS_INSTRUMENTATION 0
+ #endif
+#endif
+
+#if PROTECTEDSOUNDS_INSTRUMENTATION
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+// Contador de ciclos de la CPU (TSC en x86, contador virtual en ARM64); leerlo cuesta unos pocos
+// ciclos y no es una llamada al sistema. En el resto de plataformas, el reloj de alta resolución
+namespace CycleCounter
+{
+    inline juce::uint64 now() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+        juce::uint64 ticks;
+        asm volatile ("mrs %0, cntvct_el0" : "=r" (ticks));
+        return ticks;
+       #else
+        return (juce::uint64) juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+    // Ciclos por segundo; la primera llamada puede tardar unos milisegundos (no desde el audio)
+    double getFrequency();
+}
+
+// Acumula en accumulator los ciclos que pasan hasta el final del ámbito
+class ScopedCycleTimer
+{
+public:
+    explicit ScopedCycleTimer(juce::uint64& accumulatorToUse) noexcept
+        : accumulator(accumulatorToUse), start(CycleCounter::now()) {}
+
+    ~ScopedCycleTimer() noexcept { accumulator += CycleCounter::now() - start; }
+
+private:
+    juce::uint64& accumulator;
+    const juce::uint64 start;
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedCycleTimer)
+};
+
+// Tiempo de cada etapa de processBlock medido como fracción del plazo del bloque (numSamples /
+// sampleRate). El hilo de audio es el único que escribe: los contadores son atómicos sueltos que
+// se actualizan sin instrucciones lock y la interfaz los lee cuando quiere, sin esperar a nadie.
+// Con las capas en paralelo cada sampler cuenta el tiempo del hilo que lo renderiza, así que la
+// suma de las etapas puede pasar del total del bloque.
+class ProcessingInstrumentation
+{
+public:
+    enum Stage
+    {
+        midiStage,      // sonidos y parámetros nuevos al principio del bloque más los eventos MIDI
+        sampler1Stage,
+        sampler2Stage,
+        mixStage,       // rampas de mezcla, suma de las capas y nivel de salida
+        limiterStage,
+        blockStage,     // processBlock entero
+        numStages
+    };
+
+    // Histogramas de carga (tiempo / plazo) en tramos del 2 %; el último recoge todo lo que pasa del 200 %
+    static constexpr int numBuckets = 101;
+    static constexpr double bucketWidth = 0.02;
+
+    // Un callback que llega más de lateCallbackRatio plazos después del anterior probablemente
+    // es un xrun del host (o un hueco en su hilo de audio)
+    static constexpr double lateCallbackRatio = 2.0;
+
+    ProcessingInstrumentation() = default;
+
+    // prepareToPlay (sin audio en marcha): fija el plazo por sample y pone todo a cero
+    void prepare(double sampleRate);
+
+    // Hilo de audio ------------------------------------------------------------
+
+    // Un bloque de processBlock; al destruirse registra el bloque. Offline no hay plazo: sólo
+    // cuentan los tiempos, no los fallos de plazo ni los callbacks tardíos
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock(ProcessingInstrumentation& owner, int numSamples, bool isRealtime) noexcept;
+        ~ScopedBlock() noexcept;
+
+    private:
+        ProcessingInstrumentation& instrumentation;
+        const int numSamples;
+        const bool realtime;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+    juce::uint64& getStageCycles(Stage stage) noexcept { return currentCycles[(size_t) stage]; }
+
+    // Pasa ciclos ya contados en una etapa a otra (los eventos MIDI se procesan dentro del render)
+    void moveCycles(Stage from, Stage to, juce::uint64 cycles) noexcept;
+
+    // Hilo de mensajes ---------------------------------------------------------
+
+    // Para el medidor del editor: carga media desde la lectura anterior de este mismo marcador
+    struct LoadReading
+    {
+        juce::uint64 cycles = 0;
+        juce::uint64 budgetCycles = 0;
+    };
+
+    float getAverageLoad(LoadReading& previous) const noexcept;
+
+    // Carga del peor bloque desde la llamada anterior
+    float pullPeakLoad() noexcept { return peakLoad.exchange(0.0f, std::memory_order_relaxed); }
+
+    juce::uint64 getNumDeadlineMisses() const noexcept { return deadlineMisses.load(std::memory_order_relaxed); }
+    juce::uint64 getNumLateCallbacks() const noexcept { return lateCallbacks.load(std::memory_order_relaxed); }
+
+    // Histogramas, contadores y percentiles de todas las etapas en JSON
+    juce::String createReport() const;
+
+    static juce::String getStageName(Stage stage);
+
+private:
+    struct StageStatistics
+    {
+        std::array<std::atomic<juce::uint32>, numBuckets> histogram {};
+        std::atomic<juce::uint64> totalCycles { 0 };
+        std::atomic<juce::uint64> maxCycles { 0 };
+    };
+
+    // Sólo escribe el hilo de audio: cargar y guardar basta y no hace falta fetch_add
+    template <typename Type>
+    static void increment(std::atomic<Type>& counter, Type amount = 1) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void endBlock(juce::uint64 blockCycles, int numSamples, bool realtime) noexcept;
+
+    double cyclesPerSample { 0.0 };
+    double sampleRate { 0.0 };
+
+    // Bloque en curso (hilo de audio y, con las capas en paralelo, el worker de la capa 2)
+    std::array<juce::uint64, numStages> currentCycles {};
+    juce::uint64 blockStart { 0 };
+    juce::uint64 previousBlockStart { 0 };
+    juce::uint64 previousBudgetCycles { 0 };
+
+    std::array<StageStatistics, numStages> stages;
+    std::atomic<juce::uint64> numBlocks { 0 };
+    std::atomic<juce::uint64> totalBudgetCycles { 0 };
+    std::atomic<juce::uint64> deadlineMisses { 0 };
+    std::atomic<juce::uint64> lateCallbacks { 0 };
+    std::atomic<float> peakLoad { 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProcessingInstrumentation)
+};
+
+ #define PROTECTEDSOUNDS_INSTRUMENT_BLOCK(instrumentation, numSamples, isRealtime) \
+    const ProcessingInstrumentation::ScopedBlock instrumentedBlock (instrumentation, numSamples, isRealtime)
+ #define PROTECTEDSOUNDS_INSTRUMENT_STAGE(instrumentation, stage) \
+    const ScopedCycleTimer JUCE_JOIN_MACRO (instrumentedStage, __LINE__) ((instrumentation).getStageCycles (ProcessingInstrumentation::stage))
+ #define PROTECTEDSOUNDS_INSTRUMENT_CYCLES(accumulator) \
+    const ScopedCycleTimer JUCE_JOIN_MACRO (instrumentedCycles, __LINE__) (accumulator)
+
+#else
+
+ #define PROTECTEDSOUNDS_INSTRUMENT_BLOCK(instrumentation, numSamples, isRealtime)
+ #define PROTECTEDSOUNDS_INSTRUMENT_STAGE(instrumentation, stage)
+ #define PROTECTEDSOUNDS_INSTRUMENT_CYCLES(accumulator)
+
+#endif
@@ -0,0 +1,282 @@
+/*
+  ==============================================================================
+
+    ProtectedContainer.cpp
+    Created: 17 Oct 2026 3:05:18pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "ProtectedContainer.h"
+
+#if JUCE_LINUX || JUCE_ANDROID
+ #include <sys/random.h>
+ #include <cerrno>
+#elif JUCE_MAC || JUCE_IOS
+ #include <stdlib.h>
+#else
+ #include <random>
+#endif
+
+namespace
+{
+    const char containerMagic[4] = { 'P', 'S', 'C', '1' };
+
+    // Claves separadas para cifrar y para autenticar, derivadas de la clave del usuario
+    juce::MemoryBlock deriveKey(const juce::String& key, const char* purpose)
+    {
+        return juce::SHA256((juce::String(purpose) + key).toUTF8()).getRawData();
+    }
+
+    juce::BlowFish createCipher(const juce::String& key)
+    {
+        const auto cipherKey = deriveKey(key, "PSC1-enc");
+        return juce::BlowFish(cipherKey.getData(), (int) cipherKey.getSize());
+    }
+
+    juce::MemoryBlock hmacSha256(const juce::String& key, const void* data, size_t size)
+    {
+        constexpr size_t blockSize = 64;
+
+        const auto macKey = deriveKey(key, "PSC1-mac");
+        juce::uint8 innerPad[blockSize], outerPad[blockSize];
+
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            const auto k = i < macKey.getSize() ? (juce::uint8) macKey[(int) i] : (juce::uint8) 0;
+            innerPad[i] = k ^ 0x36;
+            outerPad[i] = k ^ 0x5c;
+        }
+
+        juce::MemoryBlock inner(innerPad, blockSize);
+        inner.append(data, size);
+        const auto innerHash = juce::SHA256(inner).getRawData();
+
+        juce::MemoryBlock outer(outerPad, blockSize);
+        outer.append(innerHash.getData(), innerHash.getSize());
+        return juce::SHA256(outer).getRawData();
+    }
+
+    // Cifra o descifra (es la misma operación) numBytes a partir de byteOffset, múltiplo de 8
+    void applyKeystream(const juce::BlowFish& blowfish, juce::uint64 nonce, juce::uint64 byteOffset,
+                        const char* source, char* dest, size_t numBytes) noexcept
+    {
+        jassert(byteOffset % 8 == 0);
+
+        for (size_t i = 0; i < numBytes; i += 8)
+        {
+            const auto counter = (byteOffset + i) / 8;
+            auto left = (juce::uint32) (nonce >> 32) ^ (juce::uint32) (counter >> 32);
+            auto right = (juce::uint32) nonce ^ (juce::uint32) counter;
+
+            blowfish.encrypt(left, right);
+
+            // El keystream se define en little endian para que el formato no dependa de la máquina
+            const juce::uint32 words[2] = { juce::ByteOrder::swapIfBigEndian(left),
+                                            juce::ByteOrder::swapIfBigEndian(right) };
+            char keystream[8];
+            memcpy(keystream, words, 8);
+
+            const auto blockBytes = juce::jmin((size_t) 8, numBytes - i);
+            for (size_t k = 0; k < blockBytes; ++k)
+                dest[i + k] = (char) (source[i + k] ^ keystream[k]);
+        }
+    }
+
+    // Nonce del generador criptográfico del sistema: impredecible y sin estado compartido entre
+    // hilos (juce::Random es un LCG de 48 bits, predecible y sin locks). False si el sistema falla
+    bool generateNonce(juce::uint64& nonce) noexcept
+    {
+       #if JUCE_LINUX || JUCE_ANDROID
+        auto* bytes = reinterpret_cast<char*>(&nonce);
+        size_t filled = 0;
+
+        while (filled < sizeof(nonce))
+        {
+            const auto result = getrandom(bytes + filled, sizeof(nonce) - filled, 0);
+
+            if (result < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                return false;
+            }
+
+            filled += (size_t) result;
+        }
+
+        return true;
+       #elif JUCE_MAC || JUCE_IOS
+        arc4random_buf(&nonce, sizeof(nonce));
+        return true;
+       #else
+        // En MSVC random_device usa el generador criptográfico de Windows (rand_s)
+        try
+        {
+            std::random_device device;
+            nonce = ((juce::uint64) device() << 32) | (juce::uint64) device();
+            return true;
+        }
+        catch (...)
+        {
+            return false;
+        }
+       #endif
+    }
+
+    size_t getTableEnd(juce::uint32 numChunks) noexcept
+    {
+        return (size_t) ProtectedContainerFormat::headerSize
+                 + (size_t) numChunks * ProtectedContainerFormat::tableEntrySize;
+    }
+}
+
+// ============================================================================
+// ProtectedContainerFormat
+// ============================================================================
+
+bool ProtectedContainerFormat::isContainer(const void* data, size_t size) noexcept
+{
+    return data != nullptr && size >= (size_t) headerSize && memcmp(data, containerMagic, 4) == 0;
+}
+
+// ============================================================================
+// ProtectedContainerWriter
+// ============================================================================
+
+bool ProtectedContainerWriter::write(juce::InputStream& input, juce::OutputStream& output,
+                                     const juce::String& key, int chunkSize)
+{
+    chunkSize = juce::jmax(8, chunkSize - chunkSize % 8);
+
+    const auto plainLength = input.getTotalLength() - input.getPosition();
+    if (plainLength < 0)
+        return false;
+
+    const auto numChunks = (juce::uint32) ((plainLength + chunkSize - 1) / chunkSize);
+    const auto tableEnd = getTableEnd(numChunks);
+    const auto dataOffset = tableEnd + ProtectedContainerFormat::tagSize;
+    juce::uint64 nonce = 0;
+
+    if (! generateNonce(nonce))
+        return false;
+
+    // Cabecera y tabla: los offsets se conocen de antemano porque el cifrado no cambia el tamaño
+    juce::MemoryOutputStream header;
+    header.write(containerMagic, 4);
+    header.writeShort((short) ProtectedContainerFormat::currentVersion);
+    header.writeShort(0);
+    header.writeInt(chunkSize);
+    header.writeInt((int) numChunks);
+    header.writeInt64(plainLength);
+    header.writeInt64((juce::int64) nonce);
+    header.writeInt(ProtectedContainerFormat::headerSize);
+    header.writeInt((int) dataOffset);
+
+    for (juce::uint32 chunk = 0; chunk < numChunks; ++chunk)
+    {
+        const auto chunkStart = (juce::int64) chunk * chunkSize;
+        header.writeInt64((juce::int64) dataOffset + chunkStart);
+        header.writeInt((int) juce::jmin((juce::int64) chunkSize, plainLength - chunkStart));
+        header.writeInt(0);
+    }
+
+    const auto tag = hmacSha256(key, header.getData(), header.getDataSize());
+
+    if (! output.write(header.getData(), header.getDataSize()) || ! output.write(tag.getData(), tag.getSize()))
+        return false;
+
+    // Datos: un único buffer del tamaño de un trozo, la memoria no depende del tamaño del archivo
+    const auto blowfish = createCipher(key);
+    juce::HeapBlock<char> plain((size_t) chunkSize), encrypted((size_t) chunkSize);
+
+    for (juce::int64 written = 0; written < plainLength;)
+    {
+        const auto bytesWanted = (int) juce::jmin((juce::int64) chunkSize, plainLength - written);
+
+        if (input.read(plain.get(), bytesWanted) != bytesWanted)
+            return false;
+
+        applyKeystream(blowfish, nonce, (juce::uint64) written, plain.get(), encrypted.get(), (size_t) bytesWanted);
+
+        if (! output.write(encrypted.get(), (size_t) bytesWanted))
+            return false;
+
+        written += bytesWanted;
+    }
+
+    output.flush();
+    return true;
+}
+
+// ============================================================================
+// ProtectedContainerReader
+// ============================================================================
+
+ProtectedContainerReader::ProtectedContainerReader(const char* containerData, const juce::String& key)
+    : data(containerData), blowfish(createCipher(key))
+{
+}
+
+std::unique_ptr<ProtectedContainerReader> ProtectedContainerReader::open(const void* containerData, size_t size,
+                                                                         const juce::String& key)
+{
+    if (! ProtectedContainerFormat::isContainer(containerData, size))
+        return nullptr;
+
+    const auto* bytes = static_cast<const char*>(containerData);
+
+    const auto version = juce::ByteOrder::littleEndianShort(bytes + 4);
+    const auto chunkSize = juce::ByteOrder::littleEndianInt(bytes + 8);
+    const auto numChunks = juce::ByteOrder::littleEndianInt(bytes + 12);
+    const auto plainLength = juce::ByteOrder::littleEndianInt64(bytes + 16);
+    const auto tableOffset = juce::ByteOrder::littleEndianInt(bytes + 32);
+
+    if (version != ProtectedContainerFormat::currentVersion
+        || chunkSize == 0 || chunkSize % 8 != 0 || chunkSize > (1u << 30)
+        || tableOffset != (juce::uint32) ProtectedContainerFormat::headerSize
+        || plainLength > (juce::uint64) size
+        || numChunks != (plainLength + chunkSize - 1) / chunkSize)
+        return nullptr;
+
+    const auto tableEnd = getTableEnd(numChunks);
+    if (tableEnd + ProtectedContainerFormat::tagSize > size)
+        return nullptr;
+
+    // La cabecera y la tabla tienen que estar autenticadas con esta clave
+    const auto expectedTag = hmacSha256(key, bytes, tableEnd);
+    if (memcmp(expectedTag.getData(), bytes + tableEnd, ProtectedContainerFormat::tagSize) != 0)
+        return nullptr;
+
+    std::unique_ptr<ProtectedContainerReader> reader(new ProtectedContainerReader(bytes, key));
+    reader->nonce = juce::ByteOrder::littleEndianInt64(bytes + 24);
+    reader->plainLength = (juce::int64) plainLength;
+    reader->chunkSize = (int) chunkSize;
+    reader->chunkOffsets.reserve(numChunks);
+
+    for (juce::uint32 chunk = 0; chunk < numChunks; ++chunk)
+    {
+        const auto* entry = bytes + ProtectedContainerFormat::headerSize
+                                  + (size_t) chunk * ProtectedContainerFormat::tableEntrySize;
+        const auto offset = juce::ByteOrder::littleEndianInt64(entry);
+        const auto plainSize = juce::ByteOrder::littleEndianInt(entry + 8);
+        const auto expectedSize = juce::jmin((juce::uint64) chunkSize, plainLength - (juce::uint64) chunk * chunkSize);
+
+        if (plainSize != expectedSize || offset > size || plainSize > size - offset)
+            return nullptr;
+
+        reader->chunkOffsets.push_back(offset);
+    }
+
+    return reader;
+}
+
+void ProtectedContainerReader::decryptChunk(juce::int64 chunkIndex, char* dest, int numBytes) const
+{
+    jassert(juce::isPositiveAndBelow(chunkIndex, (juce::int64) chunkOffsets.size()));
+
+    applyKeystream(blowfish, nonce, (juce::uint64) chunkIndex * (juce::uint64) chunkSize,
+                   data + chunkOffsets[(size_t) chunkIndex], dest, (size_t) numBytes);
+}
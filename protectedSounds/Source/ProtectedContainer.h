@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    ProtectedContainer.h
+    Created: 17 Oct 2026 3:05:18pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DecryptingInputStream.h"
+
+// Formato contenedor .psc (little endian):
+//
+//   0   char[4]  magic "PSC1"
+//   4   uint16   versión
+//   6   uint16   flags (reservado, 0)
+//   8   uint32   chunkSize (bytes de audio por trozo, múltiplo de 8)
+//   12  uint32   numChunks
+//   16  uint64   plainLength
+//   24  uint64   nonce
+//   32  uint32   tableOffset
+//   36  uint32   dataOffset
+//   40  tabla de trozos: numChunks x { uint64 offset, uint32 plainSize, uint32 reservado }
+//   ..  HMAC-SHA256 de la cabecera y la tabla (32 bytes)
+//   ..  datos
+//
+// Cada bloque de 8 bytes se cifra en modo contador: keystream = Blowfish(nonce ^ índiceDeBloque).
+// No hay padding, ningún trozo depende de otro y cualquier posición se descifra en O(1).
+//
+// La seguridad depende de que el nonce no se repita nunca con la misma clave: dos archivos con el
+// mismo nonce comparten keystream y el XOR de los dos revela el XOR de los originales. Por eso el
+// nonce sale del generador criptográfico del sistema (64 bits aleatorios por archivo) y nunca de
+// juce::Random ni de nada derivado del tiempo o del contenido.
+struct ProtectedContainerFormat
+{
+    static constexpr juce::uint16 currentVersion = 1;
+    static constexpr int headerSize = 40;
+    static constexpr int tableEntrySize = 16;
+    static constexpr int tagSize = 32;
+    static constexpr int defaultChunkSize = 65536;
+
+    static bool isContainer(const void* data, size_t size) noexcept;
+};
+
+class ProtectedContainerWriter
+{
+public:
+    // Cifra todo el stream de entrada en el de salida trozo a trozo, sin cargarlo entero.
+    // La entrada tiene que conocer su longitud (getTotalLength).
+    // No comparte estado entre llamadas (cada una saca su nonce del sistema): se puede llamar
+    // a la vez desde varios hilos, como hace el modo batch de encrypt_audio.
+    static bool write(juce::InputStream& input, juce::OutputStream& output,
+                      const juce::String& key, int chunkSize = ProtectedContainerFormat::defaultChunkSize);
+};
+
+class ProtectedContainerReader : public ChunkDecryptor
+{
+public:
+    // Devuelve nullptr si los datos no son un contenedor válido o la clave no autentica la cabecera.
+    // Los datos tienen que seguir vivos mientras exista el lector.
+    static std::unique_ptr<ProtectedContainerReader> open(const void* data, size_t size, const juce::String& key);
+
+    juce::int64 getPlainLength() const override { return plainLength; }
+    int getChunkSize() const override { return chunkSize; }
+    void decryptChunk(juce::int64 chunkIndex, char* dest, int numBytes) const override;
+
+    int getNumChunks() const noexcept { return (int) chunkOffsets.size(); }
+
+private:
+    ProtectedContainerReader(const char* data, const juce::String& key);
+
+    const char* data;
+    juce::BlowFish blowfish;
+    juce::uint64 nonce { 0 };
+    juce::int64 plainLength { 0 };
+    int chunkSize { 0 };
+    std::vector<juce::uint64> chunkOffsets;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProtectedContainerReader)
+};
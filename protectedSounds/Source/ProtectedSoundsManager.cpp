@@ -9,6 +9,7 @@
 */
 
 #include "ProtectedSoundsManager.h"
+#include "ProtectedContainer.h"
 #include "BinaryData.h"
 #include <juce_core/juce_core.h>
 #include <juce_cryptography/juce_cryptography.h>
@@ -16,47 +17,74 @@
 
 ProtectedSoundsManager::ProtectedSoundsManager()
 {
-    // Añade los nombres de tus sonidos aquí
-    // Asegúrate de que estos nombres coincidan con los nombres de los recursos que has añadido
-    availableSounds = {"comb_57_68_v89_110", "encrypted_audio", "CiberEncriptado-two_notes"};
-    audioPairs = {
-        {"A_Crickets_Insects_Albufera_Clean", "A_Crickets_Insects_Albufera_Processed"}, {"comb_57_68_v89_110", "comb_57_68_v89_110"}
-    };
     formatManager.registerBasicFormats();
     encryptionKey = juce::String("mysecretkey").toUTF8();
 
+    // Sólo se lee el índice del paquete; el audio se mapea y no cuenta para el arranque
+    for (const auto& location : getSamplePackLocations())
+        if ((samplePack = SamplePack::open(location)) != nullptr)
+            break;
+
+    // Los sonidos disponibles y sus parejas clean/excited vienen del catálogo del paquete; sin
+    // paquete, del catalog.json que va en BinaryData con las parejas de siempre (sin metadatos)
+    int size;
+    if (const char* json = findResource(SoundCatalog::resourceName, size))
+    {
+        juce::String error;
+        if (! catalog.loadFromJSON(juce::String::fromUTF8(json, size), error))
+            DBG("Sound catalog: " << error);
+    }
+
+    // Un catálogo vacío deja los selectores vacíos: tiene que verse en Debug
+    jassert(! catalog.getSounds().empty());
+
 }
 
 juce::StringArray ProtectedSoundsManager::getAvailableSounds() const
 {
-    //return availableSounds;
-    
-    juce::StringArray names;
-    for (const auto& pair : audioPairs)
-        names.add(pair.cleanName);
-    return names;
+    return catalog.getNames();
 }
 
-std::pair<std::unique_ptr<juce::MemoryInputStream>, std::unique_ptr<juce::MemoryInputStream>>
-ProtectedSoundsManager::loadSoundPair(const juce::String& baseName)
+std::pair<std::unique_ptr<juce::InputStream>, std::unique_ptr<juce::InputStream>>
+ProtectedSoundsManager::loadSoundPair(const juce::String& baseName, Decryption decryption)
 {
-    // Buscar el par correspondiente
-    for (const auto& pair : audioPairs)
+    if (const auto* info = catalog.find(baseName))
     {
-        if (pair.cleanName == baseName)
-        {
-            auto cleanStream = loadSound(pair.cleanName);
-            auto excitedStream = loadSound(pair.excitedName);
-            return {std::move(cleanStream), std::move(excitedStream)};
-        }
+        auto cleanStream = openSound(info->cleanResource, decryption);
+        auto excitedStream = openSound(info->excitedResource, decryption);
+        return {std::move(cleanStream), std::move(excitedStream)};
     }
     return {nullptr, nullptr};
 }
 
+std::pair<std::unique_ptr<juce::AudioFormatReader>, std::unique_ptr<juce::AudioFormatReader>>
+ProtectedSoundsManager::openReaderPair(const juce::String& baseName, Decryption decryption)
+{
+    auto [cleanStream, excitedStream] = loadSoundPair(baseName, decryption);
+
+    if (cleanStream == nullptr || excitedStream == nullptr)
+        return {};
+
+    return { std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(std::move(cleanStream))),
+             std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(std::move(excitedStream))) };
+}
+
+std::unique_ptr<juce::InputStream> ProtectedSoundsManager::openSound(const juce::String& soundName, Decryption decryption)
+{
+    if (decryption == Decryption::whole)
+        if (auto decrypted = loadSoundDecrypted(soundName))
+            return decrypted;
+
+    if (auto encrypted = loadSoundEncrypted(soundName))
+        return encrypted;
+
+    return loadSound(soundName);
+}
+
 std::unique_ptr<juce::MemoryInputStream> ProtectedSoundsManager::loadSound(const juce::String& soundName)
 {
     int size;
-    const char* data = BinaryData::getNamedResource((soundName + "_wav").toRawUTF8(), size);
+    const char* data = findResource(soundName + "_wav", size);
     if (data != nullptr && size > 0)
     {
         return std::make_unique<juce::MemoryInputStream>(data, size, false);
@@ -64,40 +92,72 @@ std::unique_ptr<juce::MemoryInputStream> ProtectedSoundsManager::loadSound(const
     return nullptr;
 }
 
-std::unique_ptr<juce::MemoryInputStream> ProtectedSoundsManager::loadSoundEncrypted(const juce::String& soundName)
+juce::Array<juce::File> ProtectedSoundsManager::getSamplePackLocations()
 {
-    int size;
-    const char* encryptedData = BinaryData::getNamedResource((soundName + "_encrypted").toRawUTF8(), size);
+    // currentApplicationFile es el propio plugin cuando se carga en un host
+    const auto appData = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory);
+    const auto commonData = juce::File::getSpecialLocation(juce::File::commonApplicationDataDirectory);
+
+    return { juce::File::getSpecialLocation(juce::File::currentApplicationFile).getSiblingFile(samplePackFileName),
+             appData.getChildFile("protectedSounds").getChildFile(samplePackFileName),
+             commonData.getChildFile("protectedSounds").getChildFile(samplePackFileName) };
+}
+
+const char* ProtectedSoundsManager::findResource(const juce::String& resourceName, int& size) const
+{
+    if (samplePack != nullptr)
+        if (auto* data = samplePack->getNamedResource(resourceName, size))
+            return data;
+
+    return BinaryData::getNamedResource(resourceName.toRawUTF8(), size);
+}
+
+std::unique_ptr<ChunkDecryptor> ProtectedSoundsManager::createDecryptor(const juce::String& soundName) const
+{
+    // Primero el formato contenedor; si no existe, el recurso cifrado antiguo
+    for (auto suffix : { "_psc", "_encrypted" })
+    {
+        int size;
+        const char* encryptedData = findResource(soundName + suffix, size);
+        
+        if (encryptedData == nullptr || size <= 0)
+            continue;
+        
+        if (ProtectedContainerFormat::isContainer(encryptedData, (size_t) size))
+            return ProtectedContainerReader::open(encryptedData, (size_t) size, encryptionKey);
+        
+        return std::make_unique<LegacyBlowfishDecryptor>(encryptedData, (size_t) size, encryptionKey);
+    }
+    return nullptr;
+}
+
+std::unique_ptr<juce::InputStream> ProtectedSoundsManager::loadSoundEncrypted(const juce::String& soundName)
+{
+    // No se descifra nada aquí: el stream descifra cada trozo la primera vez que se lee
+    if (auto decryptor = createDecryptor(soundName))
+        return std::make_unique<DecryptingInputStream>(std::move(decryptor));
     
-    if (encryptedData != nullptr && size > 0)
+    return nullptr;
+}
+
+std::unique_ptr<juce::InputStream> ProtectedSoundsManager::loadSoundDecrypted(const juce::String& soundName)
+{
+    if (auto decryptor = createDecryptor(soundName))
     {
-        // Crear una instancia de BlowFish
-        juce::BlowFish blowfish(encryptionKey.toUTF8(), encryptionKey.length());
-
-        // Crear un buffer para los datos desencriptados
-        juce::MemoryBlock decryptedBlock(size);
-        char* decryptedData = static_cast<char*>(decryptedBlock.getData());
-
-        // Desencriptar los datos en bloques de 8 bytes (64 bits)
-        for (int i = 0; i < size; i += 8)
-        {
-            juce::uint32 left = *reinterpret_cast<const juce::uint32*>(encryptedData + i);
-            juce::uint32 right = *reinterpret_cast<const juce::uint32*>(encryptedData + i + 4);
-            
-            blowfish.decrypt(left, right);
-            
-            *reinterpret_cast<juce::uint32*>(decryptedData + i) = left;
-            *reinterpret_cast<juce::uint32*>(decryptedData + i + 4) = right;
-        }
-
-        // Eliminar el padding PKCS7 si se aplicó durante la encriptación
-        int paddingSize = decryptedData[size - 1];
-        if (paddingSize > 0 && paddingSize <= 8)
-        {
-            decryptedBlock.setSize(size - paddingSize, true);
-        }
-
-        return std::make_unique<juce::MemoryInputStream>(decryptedBlock, true);
+        juce::MemoryBlock decryptedBlock((size_t) decryptor->getPlainLength());
+        decryptAllChunks(*decryptor, static_cast<char*>(decryptedBlock.getData()), &getDecryptPool());
+        return std::make_unique<juce::MemoryInputStream>(std::move(decryptedBlock));
     }
     return nullptr;
 }
+
+juce::ThreadPool& ProtectedSoundsManager::getDecryptPool()
+{
+    // Varias instancias cargan a la vez desde sus propios hilos
+    const juce::ScopedLock sl(decryptPoolLock);
+
+    if (decryptPool == nullptr)
+        decryptPool = std::make_unique<juce::ThreadPool>(juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1));
+
+    return *decryptPool;
+}
@@ -11,36 +11,68 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DecryptingInputStream.h"
+#include "SamplePack.h"
+#include "SoundCatalog.h"
 
 class ProtectedSoundsManager
 {
 public:
-    
-    struct AudioPair {
-        juce::String cleanName;
-        juce::String excitedName;
-    };
-    
+    // Cómo se descifran los recursos cifrados: trozo a trozo a medida que se leen, o enteros al
+    // abrirlos, repartiendo los trozos entre varios hilos (para sonidos que se van a leer enteros)
+    enum class Decryption { lazy, whole };
+
     ProtectedSoundsManager();
     ~ProtectedSoundsManager() = default;
 
     // Devuelve una lista de los nombres de los sonidos disponibles
     juce::StringArray getAvailableSounds() const;
 
+    // Metadatos precalculados del catálogo (nullptr si el sonido no existe)
+    const SoundInfo* getSoundInfo(const juce::String& soundName) const { return catalog.find(soundName); }
+
     // Carga un sonido por su nombre y devuelve un MemoryInputStream
     std::unique_ptr<juce::MemoryInputStream> loadSound(const juce::String& soundName);
-    std::unique_ptr<juce::MemoryInputStream> loadSoundEncrypted(const juce::String& soundName);
+    // Los recursos cifrados se descifran por trozos a medida que se leen.
+    // Acepta contenedores .psc ("_psc") y los recursos "_encrypted" antiguos.
+    std::unique_ptr<juce::InputStream> loadSoundEncrypted(const juce::String& soundName);
+    
+    // Descifra el recurso completo de una vez, repartiendo los trozos entre varios hilos
+    std::unique_ptr<juce::InputStream> loadSoundDecrypted(const juce::String& soundName);
     
-    std::pair<std::unique_ptr<juce::MemoryInputStream>, std::unique_ptr<juce::MemoryInputStream>>
-    loadSoundPair(const juce::String& baseName);
+    // Usa la versión cifrada si existe y si no el recurso "_wav".
+    // Se puede llamar desde varios hilos a la vez: cada llamada devuelve streams nuevos.
+    std::pair<std::unique_ptr<juce::InputStream>, std::unique_ptr<juce::InputStream>>
+    loadSoundPair(const juce::String& baseName, Decryption decryption = Decryption::lazy);
+
+    // Igual que loadSoundPair pero ya con los lectores de audio creados
+    std::pair<std::unique_ptr<juce::AudioFormatReader>, std::unique_ptr<juce::AudioFormatReader>>
+    openReaderPair(const juce::String& baseName, Decryption decryption = Decryption::lazy);
 
     
 
+    // Paquete externo de sonidos en uso (junto al plugin o en la carpeta de datos de la aplicación)
+    static juce::Array<juce::File> getSamplePackLocations();
+    juce::File getSamplePackFile() const { return samplePack != nullptr ? samplePack->getFile() : juce::File(); }
+
 private:
-    std::vector<AudioPair> audioPairs;
-    juce::StringArray availableSounds;
+    static constexpr const char* samplePackFileName = "protectedSounds.pspk";
+
+    // Busca primero en el paquete (sin copia, sobre el mapeo) y después en BinaryData
+    const char* findResource(const juce::String& resourceName, int& size) const;
+    std::unique_ptr<ChunkDecryptor> createDecryptor(const juce::String& soundName) const;
+    std::unique_ptr<juce::InputStream> openSound(const juce::String& soundName, Decryption decryption);
+
+    // Los hilos del descifrado en paralelo se crean la primera vez que hacen falta: un host que
+    // sólo usa sonidos en streaming (o sin cifrar) no tiene hilos parados por cada proceso
+    juce::ThreadPool& getDecryptPool();
+    
+    SoundCatalog catalog;
     juce::String encryptionKey;
     juce::AudioFormatManager formatManager;
+    std::unique_ptr<SamplePack> samplePack;
 
+    juce::CriticalSection decryptPoolLock;
+    std::unique_ptr<juce::ThreadPool> decryptPool;
 
 };
@@ -0,0 +1,626 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyAudit.cpp
+    Created: 18 Oct 2026 8:02:44pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+// Herramienta de consola aparte, como OfflineRender: se compila con Tools/CMakeLists.txt (ver
+// Tools/README.md, también corre con ctest) y comprueba que processBlock es seguro para tiempo
+// real. Un hilo hace de hilo de audio del host y llama a processBlock sin parar mientras el
+// hilo principal carga sonidos, mueve el loop, activa y desactiva las capas en paralelo, cambia
+// parámetros y restaura el estado, como harían el editor y el host.
+// Mientras el hilo de audio está dentro de processBlock se interceptan:
+//
+//   - reservas y liberaciones de memoria (malloc, free, new, delete...)
+//   - locks (pthread_mutex_lock, rwlocks, condition variables, semáforos)
+//   - llamadas al sistema que pueden bloquear (sleep, E/S de ficheros, poll...)
+//
+// Cada violación distinta (tipo más pila) se guarda con la pila de la primera vez y cuántas
+// veces ha pasado. Si hay alguna, la herramienta termina con código 1, salvo que su pila pase
+// por un símbolo permitido (--allow, además de los de defaultAllowed, que el informe lista con
+// su motivo). Con ParallelLayers sólo se audita el hilo de audio: lo que renderiza el worker
+// del pool no pasa por aquí.
+// malloc, locks y llamadas al sistema sólo se interceptan en Linux (glibc, por interposición de
+// símbolos); en el resto de plataformas sólo se comprueban new y delete.
+//
+//   RealtimeSafetyAudit [--seconds <s por escenario>] [--block-size <n>] [--allow <símbolo>]...
+
+#include "JuceHeader.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include "PluginProcessor.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <execinfo.h>
+ #include <cxxabi.h>
+#endif
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <cstdarg>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <poll.h>
+ #include <sys/select.h>
+#endif
+
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+// ============================================================================
+// Registro de violaciones
+// ============================================================================
+
+namespace audit
+{
+    enum class Kind { allocation, deallocation, lock, systemCall };
+
+    constexpr int maxFrames = 32;
+    constexpr int maxViolations = 256;
+
+    struct Violation
+    {
+        Kind kind = Kind::allocation;
+        const char* function = nullptr;
+        int scenario = 0;
+        juce::uint64 hash = 0;
+        juce::uint64 count = 0;
+        int numFrames = 0;
+        void* frames[maxFrames] {};
+    };
+
+    // Sólo escribe el hilo auditado; el informe se lee cuando ya ha terminado
+    Violation violations[maxViolations];
+    int numViolations = 0;
+    juce::uint64 droppedViolations = 0;
+
+    std::atomic<int> currentScenario { 0 };
+
+    thread_local bool auditing = false;
+    thread_local bool inHook = false;
+
+    // Guarda la violación sin reservar memoria ni tomar locks: se llama desde dentro de malloc
+    void report(Kind kind, const char* function) noexcept
+    {
+        if (! auditing || inHook)
+            return;
+
+        inHook = true;
+
+        void* frames[maxFrames];
+        int numFrames = 0;
+
+       #if JUCE_LINUX || JUCE_MAC
+        numFrames = backtrace(frames, maxFrames);
+       #endif
+
+        // FNV-1a del tipo y las direcciones de retorno
+        juce::uint64 hash = 14695981039346656037ull ^ (juce::uint64) kind;
+
+        for (int i = 0; i < numFrames; ++i)
+            hash = (hash ^ (juce::uint64) (juce::pointer_sized_uint) frames[i]) * 1099511628211ull;
+
+        auto* end = violations + numViolations;
+        auto* existing = std::find_if(violations, end, [hash](const Violation& v) { return v.hash == hash; });
+
+        if (existing != end)
+            ++existing->count;
+        else if (numViolations < maxViolations)
+        {
+            auto& v = violations[numViolations++];
+            v.kind = kind;
+            v.function = function;
+            v.scenario = currentScenario.load(std::memory_order_relaxed);
+            v.hash = hash;
+            v.count = 1;
+            v.numFrames = numFrames;
+            std::copy(frames, frames + numFrames, v.frames);
+        }
+        else
+            ++droppedViolations;
+
+        inHook = false;
+    }
+
+    // Marca el tramo auditado: sólo la llamada a processBlock, no el código del "host"
+    struct ScopedAudit
+    {
+        ScopedAudit() noexcept { auditing = true; }
+        ~ScopedAudit() { auditing = false; }
+    };
+
+    const char* getKindName(Kind kind)
+    {
+        switch (kind)
+        {
+            case Kind::allocation:   return "allocation";
+            case Kind::deallocation: return "deallocation";
+            case Kind::lock:         return "lock";
+            case Kind::systemCall:   return "blocking system call";
+        }
+
+        return "";
+    }
+
+    juce::String demangle(const juce::String& symbolLine)
+    {
+       #if JUCE_LINUX || JUCE_MAC
+        // Linux: "modulo(_ZSimbolo+0x1f) [0x...]"; macOS: "n modulo 0x... _ZSimbolo + 31"
+        const auto mangled = symbolLine.contains("(") ? symbolLine.fromFirstOccurrenceOf("(", false, false).upToFirstOccurrenceOf("+", false, false)
+                                                      : symbolLine.fromLastOccurrenceOf(" 0x", false, false).fromFirstOccurrenceOf(" ", false, false).upToFirstOccurrenceOf(" ", false, false);
+        int status = 0;
+
+        if (auto* name = abi::__cxa_demangle(mangled.toRawUTF8(), nullptr, nullptr, &status))
+        {
+            const juce::String result(name);
+            std::free(name);
+            return result;
+        }
+       #endif
+
+        return symbolLine;
+    }
+
+    juce::String describeStack(const Violation& v)
+    {
+        juce::String stack;
+
+       #if JUCE_LINUX || JUCE_MAC
+        if (auto** symbols = backtrace_symbols(v.frames, v.numFrames))
+        {
+            // Los dos primeros marcos son report() y el hook
+            for (int i = 2; i < v.numFrames; ++i)
+                stack << "      " << demangle(symbols[i]) << juce::newLine;
+
+            std::free(symbols);
+        }
+       #endif
+
+        return stack;
+    }
+}
+
+// ============================================================================
+// Interceptores
+// ============================================================================
+
+#if JUCE_LINUX
+
+// glibc exporta sus implementaciones con otro nombre: se puede sustituir malloc sin dlsym
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size)                { audit::report(audit::Kind::allocation, "malloc"); return __libc_malloc(size); }
+    void* calloc(size_t n, size_t size)      { audit::report(audit::Kind::allocation, "calloc"); return __libc_calloc(n, size); }
+    void* realloc(void* p, size_t size)      { audit::report(audit::Kind::allocation, "realloc"); return __libc_realloc(p, size); }
+    void* memalign(size_t align, size_t size) { audit::report(audit::Kind::allocation, "memalign"); return __libc_memalign(align, size); }
+    void* aligned_alloc(size_t align, size_t size) { audit::report(audit::Kind::allocation, "aligned_alloc"); return __libc_memalign(align, size); }
+
+    int posix_memalign(void** result, size_t align, size_t size)
+    {
+        audit::report(audit::Kind::allocation, "posix_memalign");
+        *result = __libc_memalign(align, size);
+        return *result != nullptr || size == 0 ? 0 : ENOMEM;
+    }
+
+    void free(void* p)
+    {
+        if (p != nullptr)
+            audit::report(audit::Kind::deallocation, "free");
+
+        __libc_free(p);
+    }
+}
+
+// El resto llama a la función original, que se busca la primera vez con dlsym. Los punteros
+// se inicializan a nullptr al cargar, sin guarda que pueda volver a entrar en pthread_mutex_lock
+#define AUDIT_FORWARD(kind, returnType, name, parameters, arguments)                  \
+    extern "C" returnType name parameters                                             \
+    {                                                                                 \
+        using Function = returnType (*) parameters;                                   \
+        static Function real##name = nullptr;                                         \
+        audit::report(audit::Kind::kind, #name);                                      \
+        if (real##name == nullptr)                                                    \
+            real##name = (Function) dlsym(RTLD_NEXT, #name);                          \
+        return real##name arguments;                                                  \
+    }
+
+AUDIT_FORWARD(lock, int, pthread_mutex_lock, (pthread_mutex_t* m), (m))
+AUDIT_FORWARD(lock, int, pthread_rwlock_rdlock, (pthread_rwlock_t* l), (l))
+AUDIT_FORWARD(lock, int, pthread_rwlock_wrlock, (pthread_rwlock_t* l), (l))
+AUDIT_FORWARD(lock, int, pthread_cond_wait, (pthread_cond_t* c, pthread_mutex_t* m), (c, m))
+AUDIT_FORWARD(lock, int, pthread_cond_timedwait, (pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* t), (c, m, t))
+AUDIT_FORWARD(lock, int, pthread_join, (pthread_t t, void** r), (t, r))
+AUDIT_FORWARD(lock, int, sem_wait, (sem_t* s), (s))
+AUDIT_FORWARD(lock, int, sem_timedwait, (sem_t* s, const struct timespec* t), (s, t))
+
+AUDIT_FORWARD(systemCall, int, nanosleep, (const struct timespec* t, struct timespec* r), (t, r))
+AUDIT_FORWARD(systemCall, int, clock_nanosleep, (clockid_t c, int f, const struct timespec* t, struct timespec* r), (c, f, t, r))
+AUDIT_FORWARD(systemCall, int, usleep, (useconds_t u), (u))
+AUDIT_FORWARD(systemCall, unsigned int, sleep, (unsigned int s), (s))
+AUDIT_FORWARD(systemCall, ssize_t, read, (int fd, void* b, size_t n), (fd, b, n))
+AUDIT_FORWARD(systemCall, ssize_t, write, (int fd, const void* b, size_t n), (fd, b, n))
+AUDIT_FORWARD(systemCall, int, close, (int fd), (fd))
+AUDIT_FORWARD(systemCall, int, fsync, (int fd), (fd))
+AUDIT_FORWARD(systemCall, int, poll, (struct pollfd* f, nfds_t n, int t), (f, n, t))
+AUDIT_FORWARD(systemCall, int, select, (int n, fd_set* r, fd_set* w, fd_set* e, struct timeval* t), (n, r, w, e, t))
+
+// open y openat son variádicas: el modo sólo viene con O_CREAT
+extern "C" int open(const char* path, int flags, ...)
+{
+    using Function = int (*)(const char*, int, ...);
+    static Function realOpen = nullptr;
+    audit::report(audit::Kind::systemCall, "open");
+
+    if (realOpen == nullptr)
+        realOpen = (Function) dlsym(RTLD_NEXT, "open");
+
+    va_list args;
+    va_start(args, flags);
+    const auto mode = (flags & O_CREAT) != 0 ? va_arg(args, int) : 0;
+    va_end(args);
+
+    return realOpen(path, flags, mode);
+}
+
+extern "C" int openat(int dir, const char* path, int flags, ...)
+{
+    using Function = int (*)(int, const char*, int, ...);
+    static Function realOpenat = nullptr;
+    audit::report(audit::Kind::systemCall, "openat");
+
+    if (realOpenat == nullptr)
+        realOpenat = (Function) dlsym(RTLD_NEXT, "openat");
+
+    va_list args;
+    va_start(args, flags);
+    const auto mode = (flags & O_CREAT) != 0 ? va_arg(args, int) : 0;
+    va_end(args);
+
+    return realOpenat(dir, path, flags, mode);
+}
+
+#undef AUDIT_FORWARD
+
+#else
+
+// Sin interposición de símbolos sólo se ven las reservas de C++
+void* operator new(size_t size)
+{
+    audit::report(audit::Kind::allocation, "operator new");
+
+    if (auto* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    audit::report(audit::Kind::allocation, "operator new[]");
+
+    if (auto* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p != nullptr)
+        audit::report(audit::Kind::deallocation, "operator delete");
+
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    if (p != nullptr)
+        audit::report(audit::Kind::deallocation, "operator delete[]");
+
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept   { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete[](p); }
+
+#endif
+
+// ============================================================================
+// Escenarios
+// ============================================================================
+
+namespace
+{
+    constexpr int loadTimeoutMs = 60000;
+    constexpr int numPatternSteps = 64;
+
+    // Violaciones conocidas que no hacen fallar la auditoría; el informe las marca con el motivo
+    struct AllowedSymbol
+    {
+        const char* symbol;
+        const char* reason;
+    };
+
+    const AllowedSymbol defaultAllowed[] =
+    {
+        { "juce::Synthesiser::", "the synthesiser lock is only taken by the audio thread, so it is never contended" },
+
+        // RenderWorkerPool::run despierta al worker con WaitableEvent::signal, que toma el mutex
+        // del evento. El worker sólo lo retiene para mirar la señal antes de dormirse y, si
+        // tarda en despertar, el hilo de audio hace su trabajo en vez de esperarlo
+        { "juce::WaitableEvent::signal", "RenderWorkerPool wake-up: the worker holds the event mutex only around its wait" }
+    };
+
+    const char* const scenarioNames[] = { "playback", "parallel layers", "sound loading", "loop wraps",
+                                          "parameter changes", "host automation", "state restore" };
+
+    void setParameter(ProtectedSoundsAudioProcessor& processor, const juce::String& id, float value)
+    {
+        if (auto* parameter = processor.getAPVTS().getParameter(id))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Hace de hilo de audio del host. Los MidiBuffer se preparan antes: añadir eventos reserva
+    // memoria y eso es cosa del host, no del plugin
+    class AudioThread : public juce::Thread
+    {
+    public:
+        AudioThread(ProtectedSoundsAudioProcessor& processorToAudit, int blockSize)
+            : juce::Thread("Audited Audio Thread"),
+              processor(processorToAudit),
+              buffer(2, blockSize)
+        {
+            // Acordes que pasan de la polifonía (robo de voces), notas sueltas y silencios
+            for (int step = 0; step < numPatternSteps; ++step)
+            {
+                auto& midi = pattern[(size_t) step];
+                const auto root = 36 + (step * 5) % 48;
+
+                if (step % 8 == 0)
+                    midi.addEvent(juce::MidiMessage::allNotesOff(1), 0);
+
+                for (int i = 0; i < (step % 16 == 4 ? 40 : 3); ++i)
+                    midi.addEvent(juce::MidiMessage::noteOn(1, root + (i * 4) % 40, 0.3f + 0.1f * (float) (i % 7)), (i * 7) % blockSize);
+
+                midi.addEvent(juce::MidiMessage::noteOff(1, root), blockSize / 2);
+            }
+        }
+
+        ~AudioThread() override { stopThread(5000); }
+
+        // El cambio de parámetros que hace un host al reproducir automatización llega en el
+        // hilo de audio, antes de processBlock. El código del host no se audita
+        std::atomic<bool> automate { false };
+
+        void run() override
+        {
+            juce::Random random(42);
+            auto& parameters = processor.getParameters();
+
+            for (int block = 0; ! threadShouldExit(); ++block)
+            {
+                if (automate.load())
+                    if (auto* parameter = parameters[random.nextInt(parameters.size())])
+                        parameter->setValueNotifyingHost(random.nextFloat());
+
+                auto& midi = pattern[(size_t) (block % numPatternSteps)];
+
+                audit::ScopedAudit scope;
+                processor.processBlock(buffer, midi);
+            }
+        }
+
+    private:
+        ProtectedSoundsAudioProcessor& processor;
+        juce::AudioBuffer<float> buffer;
+        std::array<juce::MidiBuffer, numPatternSteps> pattern;
+    };
+
+    void runFor(double seconds, std::function<void()> action, int intervalMs)
+    {
+        const auto end = juce::Time::getMillisecondCounterHiRes() + seconds * 1000.0;
+
+        while (juce::Time::getMillisecondCounterHiRes() < end)
+        {
+            if (action != nullptr)
+                action();
+
+            juce::Thread::sleep(intervalMs);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    double secondsPerScenario = 3.0;
+    int blockSize = 256;
+    const double sampleRate = 48000.0;
+    juce::StringArray allowed, allowedReasons;
+
+    for (const auto& entry : defaultAllowed)
+    {
+        allowed.add(entry.symbol);
+        allowedReasons.add(entry.reason);
+    }
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+
+        if (arg == "--seconds" && i + 1 < argc)
+            secondsPerScenario = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--block-size" && i + 1 < argc)
+            blockSize = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--allow" && i + 1 < argc)
+        {
+            allowed.add(argv[++i]);
+            allowedReasons.add("--allow");
+        }
+        else
+        {
+            std::cout << "Usage: RealtimeSafetyAudit [--seconds <s per scenario>] [--block-size <n>] [--allow <symbol>]..." << std::endl;
+            return 1;
+        }
+    }
+
+   #if JUCE_LINUX || JUCE_MAC
+    // La primera llamada a backtrace carga libgcc y reserva memoria: que no pase dentro de un hook
+    void* warmUp[4];
+    backtrace(warmUp, 4);
+   #else
+    std::cout << "Note: only operator new/delete are intercepted on this platform" << std::endl;
+   #endif
+
+    std::unique_ptr<juce::AudioProcessor> base(createPluginFilter());
+    auto* processor = dynamic_cast<ProtectedSoundsAudioProcessor*>(base.get());
+
+    if (processor == nullptr)
+    {
+        std::cerr << "Error: createPluginFilter() did not return a ProtectedSoundsAudioProcessor" << std::endl;
+        return 1;
+    }
+
+    const auto sounds = processor->getAvailableSounds();
+
+    if (sounds.isEmpty())
+    {
+        std::cerr << "Error: no sounds available" << std::endl;
+        return 1;
+    }
+
+    processor->setPlayConfigDetails(0, 2, sampleRate, blockSize);
+    processor->prepareToPlay(sampleRate, blockSize);
+    processor->loadSoundPairForSelector1(sounds[0]);
+    processor->loadSoundPairForSelector2(sounds[sounds.size() > 1 ? 1 : 0]);
+    processor->waitForSoundLoads(loadTimeoutMs);
+
+    AudioThread audioThread(*processor, blockSize);
+    audioThread.startThread();
+
+    juce::Random random(7);
+    int nextSound = 0;
+    juce::MemoryBlock savedState;
+
+    // Sin bucle de mensajes la actualización asíncrona del pool no llega nunca: después de
+    // tocar ParallelLayers el hilo principal crea o destruye el pool él mismo
+    const auto setParallelLayers = [&](bool enabled)
+    {
+        setParameter(*processor, "ParallelLayers", enabled ? 1.0f : 0.0f);
+        processor->updateRenderPool();
+    };
+
+    // playback: sólo notas
+    audit::currentScenario = 0;
+    runFor(secondsPerScenario, nullptr, 10);
+
+    // parallel layers: las dos capas repartidas con el pool; de vez en cuando se apaga y se
+    // vuelve a encender, para crear y destruir el pool con el audio en marcha
+    audit::currentScenario = 1;
+    setParallelLayers(true);
+    runFor(secondsPerScenario, [&]
+    {
+        if (random.nextInt(10) == 0)
+        {
+            setParallelLayers(false);
+            setParallelLayers(true);
+        }
+    }, 50);
+
+    // sound loading: sonidos nuevos mientras suenan los anteriores (publicación y retirada de datos)
+    audit::currentScenario = 2;
+    runFor(secondsPerScenario, [&]
+    {
+        processor->loadSoundPairForSelector1(sounds[nextSound++ % sounds.size()]);
+        processor->loadSoundPairForSelector2(sounds[nextSound++ % sounds.size()]);
+    }, 150);
+
+    // loop wraps: loops cortos y con crossfade para que las voces salten muchas veces
+    audit::currentScenario = 3;
+    processor->setLoopEnabled(true);
+    runFor(secondsPerScenario, [&]
+    {
+        const auto start = (int64_t) random.nextInt((int) sampleRate / 2);
+        processor->setLoopPoints(start, start + 200 + random.nextInt((int) sampleRate / 10));
+
+        if (auto* crossfade = processor->getAPVTS().getParameter("LoopCrossfade"))
+            crossfade->setValueNotifyingHost(random.nextFloat() * 0.2f);
+    }, 20);
+
+    // parameter changes: desde el hilo de mensajes, como el editor
+    audit::currentScenario = 4;
+    runFor(secondsPerScenario, [&]
+    {
+        for (auto* parameter : processor->getParameters())
+            if (random.nextInt(4) == 0)
+                parameter->setValueNotifyingHost(random.nextFloat());
+
+        processor->updateRenderPool();
+    }, 5);
+
+    // host automation: desde el hilo de audio, entre bloques
+    audit::currentScenario = 5;
+    audioThread.automate = true;
+    runFor(secondsPerScenario, [&] { processor->updateRenderPool(); }, 10);
+    audioThread.automate = false;
+
+    // state restore: el host guarda y restaura el estado mientras suena
+    audit::currentScenario = 6;
+    runFor(secondsPerScenario, [&]
+    {
+        processor->getStateInformation(savedState);
+        processor->setStateInformation(savedState.getData(), (int) savedState.getSize());
+        processor->updateRenderPool();
+    }, 20);
+
+    audioThread.stopThread(5000);
+
+    // Informe: fuera del tramo auditado ya se puede reservar memoria
+    int numFailures = 0;
+
+    for (int i = 0; i < audit::numViolations; ++i)
+    {
+        const auto& v = audit::violations[i];
+        const auto stack = audit::describeStack(v);
+        int allowedIndex = -1;
+
+        for (int a = 0; a < allowed.size() && allowedIndex < 0; ++a)
+            if (stack.contains(allowed[a]))
+                allowedIndex = a;
+
+        if (allowedIndex >= 0)
+            std::cout << juce::newLine << "[allowed: " << allowedReasons[allowedIndex] << "]";
+        else
+            ++numFailures;
+
+        std::cout << juce::newLine << audit::getKindName(v.kind)
+                  << " (" << v.function << ") x" << (juce::int64) v.count
+                  << ", first seen during " << scenarioNames[v.scenario] << juce::newLine << stack;
+    }
+
+    if (audit::droppedViolations > 0)
+    {
+        std::cout << juce::newLine << (juce::int64) audit::droppedViolations << " more not recorded" << std::endl;
+        ++numFailures;
+    }
+
+    std::cout << juce::newLine << "Real-time safety audit: " << numFailures << " violation(s), "
+              << audit::numViolations - numFailures << " allowed" << std::endl;
+
+    processor->releaseResources();
+    base.reset();
+
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    RenderWorkerPool.cpp
+    Created: 18 Oct 2026 4:21:37pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "RenderWorkerPool.h"
+
+// ============================================================================
+// Worker
+// ============================================================================
+
+class RenderWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(RenderWorkerPool& ownerPool, int workerIndex)
+        : juce::Thread("Render Worker " + juce::String(workerIndex + 1)),
+          pool(ownerPool),
+          core((workerIndex + 1) % juce::jmax(1, juce::SystemStats::getNumCpus()))
+    {
+    }
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeUp.signal();
+        stopThread(1000);
+    }
+
+    void notify() noexcept { wakeUp.signal(); }
+
+    void run() override
+    {
+        // El núcleo 0 suele ser el del hilo de audio del host: los workers empiezan en el 1
+        juce::Thread::setCurrentThreadAffinityMask((juce::uint32) 1 << (core % 32));
+
+        while (! threadShouldExit())
+        {
+            wakeUp.wait(-1);
+
+            juce::ScopedNoDenormals noDenormals;
+
+            while (pool.runNextJob())
+            {
+            }
+        }
+    }
+
+private:
+    RenderWorkerPool& pool;
+    const int core;
+    juce::WaitableEvent wakeUp;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Worker)
+};
+
+// ============================================================================
+// RenderWorkerPool
+// ============================================================================
+
+RenderWorkerPool::RenderWorkerPool(int numWorkers)
+{
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, i));
+
+        // Si el sistema no da prioridad de tiempo real el hilo se queda con la más alta normal
+        worker->startRealtimeThread(juce::Thread::RealtimeOptions {});
+    }
+}
+
+RenderWorkerPool::~RenderWorkerPool()
+{
+    workers.clear();
+}
+
+void RenderWorkerPool::run(RenderJob* const* jobsToRun, int numJobsToRun) noexcept
+{
+    jassert(numJobsToRun <= maxJobs);
+    numJobsToRun = juce::jmin(numJobsToRun, maxJobs);
+
+    if (workers.isEmpty() || numJobsToRun <= 1)
+    {
+        for (int i = 0; i < numJobsToRun; ++i)
+            jobsToRun[i]->run();
+
+        return;
+    }
+
+    std::copy(jobsToRun, jobsToRun + numJobsToRun, jobs.begin());
+    jobsRemaining.store(numJobsToRun, std::memory_order_relaxed);
+
+    // Publicar el lote: un worker de un lote anterior que despierte tarde ve otra generación
+    ++generation;
+    batchState.store(((juce::uint64) generation << 32) | ((juce::uint64) numJobsToRun << 16),
+                     std::memory_order_release);
+
+    // Un worker por trabajo que sobra después del que hace el hilo de audio
+    for (int i = 0; i < juce::jmin(workers.size(), numJobsToRun - 1); ++i)
+        workers.getUnchecked(i)->notify();
+
+    while (runNextJob())
+    {
+    }
+
+    // Los trabajos que quedan ya los están haciendo los workers
+    while (jobsRemaining.load(std::memory_order_acquire) > 0)
+        juce::Thread::yield();
+}
+
+bool RenderWorkerPool::runNextJob() noexcept
+{
+    auto state = batchState.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto numJobs = (int) ((state >> 16) & indexMask);
+        const auto next = (int) (state & indexMask);
+
+        if (next >= numJobs)
+            return false;
+
+        // Mientras este trabajo no termine el lote sigue vivo y jobs no cambia
+        if (batchState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            jobs[(size_t) next]->run();
+            jobsRemaining.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+    }
+}
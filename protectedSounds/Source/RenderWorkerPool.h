@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    RenderWorkerPool.h
+    Created: 18 Oct 2026 4:21:37pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Trabajo de render que se reparte entre el hilo de audio y los workers.
+// Cada trabajo escribe en su propio buffer: da igual qué hilo lo ejecute.
+class RenderJob
+{
+public:
+    virtual ~RenderJob() = default;
+    virtual void run() noexcept = 0;
+};
+
+// Hilos de render de tiempo real, fijados cada uno a un núcleo, que ayudan al hilo de audio
+// durante un bloque. El reparto no usa locks: el lote se publica en un único atómico
+// (generación, número de trabajos, siguiente trabajo) y cada hilo reclama el siguiente con un
+// compare-exchange. El hilo de audio también reclama trabajos, así que si un worker tarda en
+// despertar su trabajo lo hace el propio hilo de audio en vez de esperarlo.
+// Lo único que no es lock-free es despertar a los workers (WaitableEvent::signal).
+class RenderWorkerPool
+{
+public:
+    static constexpr int maxJobs = 8;
+
+    // Hilo de mensajes; con numWorkers = 0 todo se ejecuta en el hilo que llama a run()
+    explicit RenderWorkerPool(int numWorkers);
+    ~RenderWorkerPool();
+
+    int getNumWorkers() const noexcept { return workers.size(); }
+
+    // Hilo de audio: ejecuta los trabajos y vuelve cuando han terminado todos
+    void run(RenderJob* const* jobsToRun, int numJobsToRun) noexcept;
+
+private:
+    class Worker;
+
+    // Estado del lote: generación en los 32 bits altos, número de trabajos y siguiente trabajo
+    // en los dos bloques de 16 bits bajos
+    static constexpr juce::uint64 indexMask = 0xffff;
+
+    bool runNextJob() noexcept;
+
+    std::array<RenderJob*, maxJobs> jobs {};
+    std::atomic<juce::uint64> batchState { 0 };
+    std::atomic<int> jobsRemaining { 0 };
+    juce::uint32 generation { 0 };
+
+    juce::OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderWorkerPool)
+};
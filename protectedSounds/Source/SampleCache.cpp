@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    SampleCache.cpp
+    Created: 17 Oct 2026 9:05:47pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "SampleCache.h"
+
+DualLayerSampleData::Ptr SampleCache::getOrLoad(const juce::String& soundName, const juce::String& format, const Loader& loader)
+{
+    const auto key = soundName + "|" + format;
+    std::shared_ptr<juce::WaitableEvent> loadFinished;
+
+    for (;;)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+
+            auto entry = entries.find(key);
+
+            if (entry != entries.end())
+            {
+                entry->second.lastUse = ++useCounter;
+                return entry->second.data;
+            }
+
+            auto inFlight = loadsInFlight.find(key);
+
+            if (inFlight == loadsInFlight.end())
+            {
+                loadFinished = std::make_shared<juce::WaitableEvent>(true);
+                loadsInFlight[key] = loadFinished;
+                break;
+            }
+
+            loadFinished = inFlight->second;
+        }
+
+        // Otro hilo está cargando esta clave: al terminar estará en la caché (o habrá fallado y se reintenta)
+        loadFinished->wait();
+    }
+
+    auto data = loader();
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (data != nullptr && data->getLength() > 0)
+        {
+            auto& entry = entries[key];
+            entry.data = data;
+            entry.sizeInBytes = data->getSizeInBytes();
+            entry.lastUse = ++useCounter;
+            memoryUsage += entry.sizeInBytes;
+
+            trimToBudget(memoryBudget);
+        }
+
+        loadsInFlight.erase(key);
+    }
+
+    loadFinished->signal();
+    return data;
+}
+
+void SampleCache::setMemoryBudget(size_t newBudgetInBytes)
+{
+    const juce::ScopedLock sl(lock);
+    memoryBudget = newBudgetInBytes;
+    trimToBudget(memoryBudget);
+}
+
+size_t SampleCache::getMemoryBudget() const
+{
+    const juce::ScopedLock sl(lock);
+    return memoryBudget;
+}
+
+size_t SampleCache::getMemoryUsage() const
+{
+    const juce::ScopedLock sl(lock);
+    return memoryUsage;
+}
+
+void SampleCache::releaseUnused()
+{
+    const juce::ScopedLock sl(lock);
+    trimToBudget(0);
+}
+
+void SampleCache::trimToBudget(size_t budgetInBytes)
+{
+    while (memoryUsage > budgetInBytes)
+    {
+        // Sólo se pueden soltar las entradas cuya única referencia es la de la caché
+        auto oldest = entries.end();
+
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.data->getReferenceCount() == 1
+                 && (oldest == entries.end() || it->second.lastUse < oldest->second.lastUse))
+                oldest = it;
+
+        if (oldest == entries.end())
+            return;
+
+        memoryUsage -= oldest->second.sizeInBytes;
+        entries.erase(oldest);
+    }
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    SampleCache.h
+    Created: 17 Oct 2026 9:05:47pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DualLayerSampler.h"
+
+// Caché de muestras decodificadas compartida por todas las instancias del plugin del proceso
+// (se usa con juce::SharedResourcePointer). Diez instancias con el mismo sonido comparten
+// una sola copia, y volver a elegir un sonido ya cargado no lo descifra ni decodifica otra vez.
+// Las entradas que nadie usa se liberan por orden LRU cuando se pasa del presupuesto de memoria.
+class SampleCache
+{
+public:
+    using Loader = std::function<DualLayerSampleData::Ptr()>;
+
+    static constexpr size_t defaultMemoryBudget = (size_t) 512 * 1024 * 1024;
+
+    SampleCache() = default;
+
+    // Devuelve los datos de la caché o los carga con loader (fuera del lock). Si otro hilo
+    // ya está cargando la misma clave, espera a que termine y comparte el resultado.
+    // format distingue decodificaciones distintas de un mismo sonido.
+    DualLayerSampleData::Ptr getOrLoad(const juce::String& soundName, const juce::String& format, const Loader& loader);
+
+    void setMemoryBudget(size_t newBudgetInBytes);
+    size_t getMemoryBudget() const;
+    size_t getMemoryUsage() const;
+
+    // Libera todas las entradas sin usuarios, aunque quepan en el presupuesto
+    void releaseUnused();
+
+private:
+    struct Entry
+    {
+        DualLayerSampleData::Ptr data;
+        size_t sizeInBytes = 0;
+        juce::uint64 lastUse = 0;
+    };
+
+    void trimToBudget(size_t budgetInBytes);
+
+    juce::CriticalSection lock;
+    std::map<juce::String, Entry> entries;
+    std::map<juce::String, std::shared_ptr<juce::WaitableEvent>> loadsInFlight;
+    size_t memoryBudget { defaultMemoryBudget };
+    size_t memoryUsage { 0 };
+    juce::uint64 useCounter { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleCache)
+};
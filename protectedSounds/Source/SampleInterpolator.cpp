@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    SampleInterpolator.cpp
+    Created: 18 Oct 2026 3:10:48am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "SampleInterpolator.h"
+
+namespace
+{
+    // Tabla polifásica de la sinc: numBands bandas de numPhases + 1 fases de numTaps pesos.
+    // La fase p corresponde a alpha = p / numPhases; la fase extra permite interpolar hasta alpha = 1.
+    struct SincTable
+    {
+        static constexpr int numTaps = SampleInterpolator::maxFramesBefore + SampleInterpolator::maxFramesAfter + 1;
+        static constexpr int numPhases = 256;
+        static constexpr int numBands = 8;
+        static constexpr float passband = 0.45f; // corte sin transponer, en ciclos por sample
+
+        static_assert(numTaps == 16, "los pesos se interpolan de 4 en 4");
+
+        SincTable()
+        {
+            for (int band = 0; band < numBands; ++band)
+            {
+                // Banda b: transposiciones de hasta 2^(b/2) hacia arriba; la 0 cubre las de bajada y el tono original
+                const auto cutoff = passband / getMaxRatio(band);
+
+                for (int phase = 0; phase <= numPhases; ++phase)
+                {
+                    const auto alpha = (double) phase / numPhases;
+                    float* weights = getPhase(band, phase);
+                    double sum = 0.0;
+
+                    for (int tap = 0; tap < numTaps; ++tap)
+                    {
+                        // Distancia del tap a la posición a interpolar
+                        const auto t = (double) (tap - SampleInterpolator::maxFramesBefore) - alpha;
+                        const auto x = 2.0 * cutoff * t;
+                        const auto sinc = std::abs(x) < 1.0e-9 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+
+                        // Ventana de Blackman centrada en la posición, de ancho numTaps
+                        const auto w = juce::jlimit(0.0, 1.0, (t + numTaps * 0.5) / numTaps);
+                        const auto window = 0.42 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * w)
+                                                 + 0.08 * std::cos(2.0 * juce::MathConstants<double>::twoPi * w);
+
+                        weights[tap] = (float) (sinc * window);
+                        sum += weights[tap];
+                    }
+
+                    // Ganancia 1 en continua en todas las fases
+                    for (int tap = 0; tap < numTaps; ++tap)
+                        weights[tap] = (float) (weights[tap] / sum);
+                }
+            }
+        }
+
+        static double getMaxRatio(int band) noexcept { return std::pow(2.0, band * 0.5); }
+
+        static int getBand(double pitchRatio) noexcept
+        {
+            for (int band = 0; band < numBands - 1; ++band)
+                if (pitchRatio <= getMaxRatio(band))
+                    return band;
+
+            return numBands - 1;
+        }
+
+        float* getPhase(int band, int phase) noexcept { return values.data() + ((size_t) band * (numPhases + 1) + (size_t) phase) * numTaps; }
+        const float* getBandData(int band) const noexcept { return values.data() + (size_t) band * (numPhases + 1) * numTaps; }
+
+        // Alineada para leer los pesos con SIMD: cada fase son 16 floats
+        alignas(16) std::array<float, (size_t) numBands * (numPhases + 1) * numTaps> values {};
+    };
+
+    // Se construye al cargar el plugin, nunca por primera vez en el hilo de audio
+    const SincTable sincTable;
+}
+
+void SampleInterpolator::prepare(Mode newMode, double pitchRatio) noexcept
+{
+    mode = newMode;
+    passthrough = pitchRatio == 1.0;
+    sincBand = sincTable.getBandData(SincTable::getBand(pitchRatio));
+}
+
+void SampleInterpolator::processSinc(const float* frame, float alpha, const float* laneGains, float* dest) const noexcept
+{
+    constexpr int numTaps = SincTable::numTaps;
+
+    // Pesos de la posición: interpolación lineal entre las dos fases vecinas de la tabla
+    const auto position = alpha * (float) SincTable::numPhases;
+    const auto phase = juce::jmin((int) position, SincTable::numPhases - 1);
+    const auto phaseAlpha = position - (float) phase;
+
+    const float* current = sincBand + (size_t) phase * numTaps;
+    const float* next = current + numTaps;
+    alignas(16) float weights[numTaps];
+
+   #if JUCE_USE_SIMD
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    if constexpr (Vec::SIMDNumElements == numLanes)
+    {
+        const auto fraction = Vec::expand(phaseAlpha);
+
+        for (int tap = 0; tap < numTaps; tap += numLanes)
+        {
+            const auto a = Vec::fromRawArray(current + tap);
+            (a + (Vec::fromRawArray(next + tap) - a) * fraction).copyToRawArray(weights + tap);
+        }
+    }
+    else
+   #endif
+    {
+        for (int tap = 0; tap < numTaps; ++tap)
+            weights[tap] = current[tap] + (next[tap] - current[tap]) * phaseAlpha;
+    }
+
+    accumulate<numTaps>(frame - maxFramesBefore * numLanes, weights, laneGains, dest);
+}
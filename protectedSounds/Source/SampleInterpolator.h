@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    SampleInterpolator.h
+    Created: 18 Oct 2026 3:10:48am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Interpolador de las voces sobre frames entrelazados [cleanL, excitedL, cleanR, excitedR].
+// Cada tap es un frame entero, así que con SIMD de 4 floats un tap es una sola multiplicación
+// y suma para las dos capas de los dos canales.
+//  - linear:  2 taps, lo que hacía SamplerVoice; barato pero con mucho aliasing lejos de la raíz.
+//  - hermite: 4 taps, cúbica de Hermite; bastante mejor por poco más.
+//  - sinc:    16 taps, sinc con ventana de Blackman sacada de una tabla polifásica. La tabla tiene
+//             una banda por media octava de transposición hacia arriba con el corte bajado en
+//             proporción, para que las notas agudas no se doblen por encima de Nyquist.
+// El modo se fija al empezar cada nota. A la frecuencia original (los datos ya vienen a la del
+// host, ver DualLayerSampleData) y sin parte fraccional la salida es una copia del frame.
+class SampleInterpolator
+{
+public:
+    enum class Mode { linear, hermite, sinc };
+
+    static constexpr int numLanes = 4;
+
+    // Frames que puede leer el modo más caro alrededor de la posición entera
+    static constexpr int maxFramesBefore = 7;
+    static constexpr int maxFramesAfter = 8;
+
+    void prepare(Mode newMode, double pitchRatio) noexcept;
+
+    Mode getMode() const noexcept { return mode; }
+    int getFramesBefore() const noexcept { return mode == Mode::sinc ? 7 : (mode == Mode::hermite ? 1 : 0); }
+    int getFramesAfter() const noexcept { return mode == Mode::sinc ? 8 : (mode == Mode::hermite ? 2 : 1); }
+
+    // frame apunta al frame de la posición entera; los getFramesBefore() anteriores y los
+    // getFramesAfter() siguientes tienen que ser contiguos en memoria
+    void process(const float* frame, float alpha, const float* laneGains, float* dest) const noexcept
+    {
+        if (passthrough && alpha == 0.0f)
+        {
+            const float weight = 1.0f;
+            accumulate<1>(frame, &weight, laneGains, dest);
+            return;
+        }
+
+        switch (mode)
+        {
+            case Mode::hermite: processHermite(frame, alpha, laneGains, dest); break;
+            case Mode::sinc:    processSinc(frame, alpha, laneGains, dest); break;
+            case Mode::linear:
+            default:            processLinear(frame, alpha, laneGains, dest); break;
+        }
+    }
+
+private:
+    static void processLinear(const float* frame, float alpha, const float* laneGains, float* dest) noexcept
+    {
+        const float weights[2] = { 1.0f - alpha, alpha };
+        accumulate<2>(frame, weights, laneGains, dest);
+    }
+
+    static void processHermite(const float* frame, float alpha, const float* laneGains, float* dest) noexcept
+    {
+        // Pesos de la cúbica de Hermite (Catmull-Rom) para los frames -1, 0, 1 y 2
+        const auto x = alpha;
+        const auto x2 = x * x;
+        const auto x3 = x2 * x;
+
+        const float weights[4] = { -0.5f * x3 + x2 - 0.5f * x,
+                                    1.5f * x3 - 2.5f * x2 + 1.0f,
+                                   -1.5f * x3 + 2.0f * x2 + 0.5f * x,
+                                    0.5f * x3 - 0.5f * x2 };
+
+        accumulate<4>(frame - numLanes, weights, laneGains, dest);
+    }
+
+    void processSinc(const float* frame, float alpha, const float* laneGains, float* dest) const noexcept;
+
+    // dest = laneGains * sum(frames[k] * weights[k])
+    template <int numTaps>
+    static void accumulate(const float* firstFrame, const float* weights, const float* laneGains, float* dest) noexcept
+    {
+       #if JUCE_USE_SIMD
+        using Vec = juce::dsp::SIMDRegister<float>;
+
+        if constexpr (Vec::SIMDNumElements == numLanes)
+        {
+            auto sum = Vec::fromRawArray(firstFrame) * weights[0];
+
+            for (int tap = 1; tap < numTaps; ++tap)
+                sum = Vec::multiplyAdd(sum, Vec::fromRawArray(firstFrame + tap * numLanes), Vec::expand(weights[tap]));
+
+            (sum * Vec::fromRawArray(laneGains)).copyToRawArray(dest);
+            return;
+        }
+       #endif
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            float sum = 0.0f;
+
+            for (int tap = 0; tap < numTaps; ++tap)
+                sum += firstFrame[tap * numLanes + lane] * weights[tap];
+
+            dest[lane] = sum * laneGains[lane];
+        }
+    }
+
+    Mode mode { Mode::linear };
+    bool passthrough { false };
+    const float* sincBand { nullptr }; // fase 0 de la banda de la tabla para esta nota
+
+    JUCE_LEAK_DETECTOR(SampleInterpolator)
+};
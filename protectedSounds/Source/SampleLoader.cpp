@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    SampleLoader.cpp
+    Created: 17 Oct 2026 5:48:22pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "SampleLoader.h"
+
+SampleLoader::SampleLoader(LoadFunction loadFunction, IdleFunction idleFunction)
+    : juce::Thread("Sample Loader"),
+      load(std::move(loadFunction)),
+      idle(std::move(idleFunction))
+{
+    startThread();
+}
+
+SampleLoader::~SampleLoader()
+{
+    stopThread(5000);
+}
+
+void SampleLoader::requestLoad(int slot, const juce::String& soundName)
+{
+    {
+        const juce::ScopedLock sl(requestLock);
+        pendingRequests[slot] = { soundName, false };
+        lastRequests[slot] = soundName;
+    }
+    notify();
+}
+
+void SampleLoader::requestReloadAll()
+{
+    {
+        const juce::ScopedLock sl(requestLock);
+
+        for (const auto& [slot, soundName] : lastRequests)
+            pendingRequests.try_emplace(slot, Request { soundName, true });
+    }
+    notify();
+}
+
+bool SampleLoader::waitUntilIdle(int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+
+    for (;;)
+    {
+        {
+            const juce::ScopedLock sl(requestLock);
+
+            if (pendingRequests.empty() && ! loading)
+                return true;
+        }
+
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        juce::Thread::sleep(5);
+    }
+}
+
+void SampleLoader::run()
+{
+    while (! threadShouldExit())
+    {
+        std::map<int, Request> requests;
+        {
+            const juce::ScopedLock sl(requestLock);
+            requests.swap(pendingRequests);
+            loading = ! requests.empty();
+        }
+
+        for (const auto& [slot, request] : requests)
+        {
+            if (threadShouldExit())
+                return;
+
+            load(slot, request.soundName, request.isReload);
+        }
+
+        {
+            const juce::ScopedLock sl(requestLock);
+            loading = false;
+        }
+
+        idle();
+        wait(idleIntervalMs);
+    }
+}
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    SampleLoader.h
+    Created: 17 Oct 2026 5:48:22pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Hilo dedicado a cargar sonidos. Los ComboBox sólo encolan la petición y vuelven;
+// la decodificación ocurre aquí y nunca en el hilo de mensajes ni en el de audio.
+class SampleLoader : private juce::Thread
+{
+public:
+    // Se llama en el hilo del cargador con cada petición. isReload indica que es el mismo sonido
+    // que ya había en el slot, pedido otra vez por requestReloadAll(), y no una elección nueva
+    using LoadFunction = std::function<void(int slot, const juce::String& soundName, bool isReload)>;
+    // Se llama en el hilo del cargador periódicamente, para liberar datos retirados
+    using IdleFunction = std::function<void()>;
+
+    SampleLoader(LoadFunction loadFunction, IdleFunction idleFunction);
+    ~SampleLoader() override;
+
+    // Si ya había una petición pendiente para ese slot, la nueva la sustituye
+    void requestLoad(int slot, const juce::String& soundName);
+
+    // Vuelve a pedir el último sonido de cada slot (p. ej. si cambia la frecuencia del host).
+    // Un slot con una elección nueva todavía pendiente se queda con ella
+    void requestReloadAll();
+
+    // Para render offline: espera a que no quede ninguna petición pendiente ni a medias.
+    // Devuelve false si se agota el tiempo
+    bool waitUntilIdle(int timeoutMs);
+
+private:
+    struct Request
+    {
+        juce::String soundName;
+        bool isReload = false;
+    };
+
+    void run() override;
+
+    LoadFunction load;
+    IdleFunction idle;
+
+    juce::CriticalSection requestLock;
+    std::map<int, Request> pendingRequests;
+    std::map<int, juce::String> lastRequests;
+    bool loading { false };
+
+    static constexpr int idleIntervalMs = 100;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleLoader)
+};
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    SamplePack.cpp
+    Created: 17 Oct 2026 9:48:31pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "SamplePack.h"
+
+namespace
+{
+    const char packMagic[4] = { 'P', 'S', 'P', 'K' };
+
+    juce::int64 alignOffset(juce::int64 offset) noexcept
+    {
+        const auto alignment = (juce::int64) SamplePackFormat::dataAlignment;
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
+
+juce::String SamplePackFormat::makeResourceName(const juce::File& file)
+{
+    // Igual que el Projucer: espacios y puntos pasan a '_', el resto de símbolos se quitan
+    auto name = file.getFileName()
+                    .replaceCharacters(" .", "__")
+                    .retainCharacters("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789");
+
+    if (juce::CharacterFunctions::isDigit(name[0]))
+        name = "_" + name;
+
+    return name;
+}
+
+// ============================================================================
+// SamplePack
+// ============================================================================
+
+SamplePack::SamplePack(const juce::File& packFile, std::unique_ptr<juce::MemoryMappedFile> mappedFile)
+    : file(packFile), mapping(std::move(mappedFile))
+{
+}
+
+std::unique_ptr<SamplePack> SamplePack::open(const juce::File& packFile)
+{
+    if (! packFile.existsAsFile())
+        return nullptr;
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(packFile, juce::MemoryMappedFile::readOnly);
+    const auto* bytes = static_cast<const char*>(mapping->getData());
+    const auto size = (juce::uint64) mapping->getSize();
+
+    if (bytes == nullptr || size < (juce::uint64) SamplePackFormat::headerSize || memcmp(bytes, packMagic, 4) != 0)
+        return nullptr;
+
+    const auto version = juce::ByteOrder::littleEndianInt(bytes + 4);
+    const auto numEntries = juce::ByteOrder::littleEndianInt(bytes + 8);
+    const auto indexSize = juce::ByteOrder::littleEndianInt(bytes + 12);
+
+    if (version != SamplePackFormat::currentVersion || indexSize > size - SamplePackFormat::headerSize)
+        return nullptr;
+
+    std::unique_ptr<SamplePack> pack(new SamplePack(packFile, std::move(mapping)));
+
+    // Sólo se recorre el índice: los datos no se tocan hasta que alguien los lee
+    const auto* entry = bytes + SamplePackFormat::headerSize;
+    const auto* indexEnd = entry + indexSize;
+
+    for (juce::uint32 i = 0; i < numEntries; ++i)
+    {
+        if (indexEnd - entry < 20)
+            return nullptr;
+
+        const auto offset = juce::ByteOrder::littleEndianInt64(entry);
+        const auto dataSize = juce::ByteOrder::littleEndianInt64(entry + 8);
+        const auto nameLength = juce::ByteOrder::littleEndianInt(entry + 16);
+        entry += 20;
+
+        if (nameLength > (juce::uint32) (indexEnd - entry)
+            || offset > size || dataSize > size - offset
+            || dataSize > (juce::uint64) std::numeric_limits<int>::max())
+            return nullptr;
+
+        const auto name = juce::String::fromUTF8(entry, (int) nameLength);
+        entry += nameLength;
+
+        pack->entries[name] = { bytes + offset, (int) dataSize };
+    }
+
+    return pack;
+}
+
+const char* SamplePack::getNamedResource(const juce::String& resourceName, int& dataSizeInBytes) const
+{
+    const auto found = entries.find(resourceName);
+
+    if (found == entries.end())
+    {
+        dataSizeInBytes = 0;
+        return nullptr;
+    }
+
+    dataSizeInBytes = found->second.size;
+    return found->second.data;
+}
+
+juce::StringArray SamplePack::getResourceNames() const
+{
+    juce::StringArray names;
+
+    for (const auto& entry : entries)
+        names.add(entry.first);
+
+    return names;
+}
+
+// ============================================================================
+// SamplePackWriter
+// ============================================================================
+
+bool SamplePackWriter::write(const juce::Array<juce::File>& files, juce::OutputStream& output, juce::String& error)
+{
+    // Primero el índice entero: los offsets se conocen porque los datos se copian tal cual
+    juce::MemoryOutputStream index;
+    juce::StringArray names;
+
+    for (const auto& file : files)
+        names.add(SamplePackFormat::makeResourceName(file));
+
+    juce::int64 indexSize = 0;
+
+    for (const auto& name : names)
+        indexSize += 20 + (juce::int64) name.getNumBytesAsUTF8();
+
+    auto offset = alignOffset(SamplePackFormat::headerSize + indexSize);
+
+    for (int i = 0; i < files.size(); ++i)
+    {
+        if (! files[i].existsAsFile())
+        {
+            error = "Input file does not exist: " + files[i].getFullPathName();
+            return false;
+        }
+
+        const auto name = names[i].toUTF8();
+        const auto nameLength = (int) name.sizeInBytes() - 1;
+
+        index.writeInt64(offset);
+        index.writeInt64(files[i].getSize());
+        index.writeInt(nameLength);
+        index.write(name.getAddress(), (size_t) nameLength);
+
+        offset = alignOffset(offset + files[i].getSize());
+    }
+
+    const auto packStart = output.getPosition();
+
+    output.write(packMagic, 4);
+    output.writeInt((int) SamplePackFormat::currentVersion);
+    output.writeInt(files.size());
+    output.writeInt((int) indexSize);
+    output.write(index.getData(), index.getDataSize());
+
+    for (const auto& file : files)
+    {
+        const auto position = output.getPosition() - packStart;
+        output.writeRepeatedByte(0, (size_t) (alignOffset(position) - position));
+
+        juce::FileInputStream input(file);
+
+        if (input.failedToOpen() || output.writeFromInputStream(input, -1) != file.getSize())
+        {
+            error = "Failed to copy " + file.getFullPathName();
+            return false;
+        }
+    }
+
+    output.flush();
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    SamplePack.h
+    Created: 17 Oct 2026 9:48:31pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Paquete externo de recursos .pspk (little endian), sustituye a los audios de BinaryData:
+//
+//   0   char[4]  magic "PSPK"
+//   4   uint32   versión
+//   8   uint32   numEntries
+//   12  uint32   indexSize (bytes del índice, justo detrás de la cabecera)
+//   16  índice: numEntries x { uint64 offset, uint64 size, uint32 nameLength, char[nameLength] nombre UTF-8 }
+//   ..  datos de cada recurso, alineados a dataAlignment
+//
+// Los nombres siguen la convención de BinaryData ("sonido.wav" -> "sonido_wav"), así que el
+// resto del código busca los recursos igual que antes.
+struct SamplePackFormat
+{
+    static constexpr juce::uint32 currentVersion = 1;
+    static constexpr int headerSize = 16;
+    static constexpr int dataAlignment = 16;
+
+    // Nombre de recurso de un archivo, como lo generaría el Projucer en BinaryData
+    static juce::String makeResourceName(const juce::File& file);
+};
+
+// Paquete abierto con un mapeo de memoria de sólo lectura. Al abrirlo sólo se lee el índice,
+// así que el arranque no depende del tamaño de la librería; las páginas de audio las carga
+// el sistema cuando se leen. Los punteros devueltos valen mientras exista el paquete.
+class SamplePack
+{
+public:
+    // Devuelve nullptr si el archivo no existe o no es un paquete válido
+    static std::unique_ptr<SamplePack> open(const juce::File& file);
+
+    // Puntero dentro del mapeo (sin copia), o nullptr si el recurso no está
+    const char* getNamedResource(const juce::String& resourceName, int& dataSizeInBytes) const;
+
+    juce::StringArray getResourceNames() const;
+    const juce::File& getFile() const noexcept { return file; }
+
+private:
+    SamplePack(const juce::File& packFile, std::unique_ptr<juce::MemoryMappedFile> mappedFile);
+
+    struct Entry
+    {
+        const char* data = nullptr;
+        int size = 0;
+    };
+
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    std::map<juce::String, Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplePack)
+};
+
+class SamplePackWriter
+{
+public:
+    // Escribe los archivos en el paquete copiándolos por streaming, sin cargarlos enteros
+    static bool write(const juce::Array<juce::File>& files, juce::OutputStream& output, juce::String& error);
+};
@@ -0,0 +1,306 @@
+/*
+  ==============================================================================
+
+    SampleStreamer.cpp
+    Created: 17 Oct 2026 8:20:13pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "SampleStreamer.h"
+#include "DualLayerSampler.h"
+
+// ============================================================================
+// VoiceStream
+// ============================================================================
+
+VoiceStream::VoiceStream()
+{
+   #if JUCE_USE_SIMD
+    const size_t alignmentPadding = juce::dsp::SIMDRegister<float>::SIMDRegisterSize / sizeof(float);
+   #else
+    const size_t alignmentPadding = 0;
+   #endif
+
+    storage.calloc((size_t) (capacity + guardFrames) * numLanes + alignmentPadding);
+
+   #if JUCE_USE_SIMD
+    ring = juce::dsp::SIMDRegister<float>::getNextSIMDAlignedPtr(storage.get());
+   #else
+    ring = storage.get();
+   #endif
+}
+
+void VoiceStream::start(const DualLayerSampleData& data, juce::int64 firstLogicalFrame, const StreamLoop& newLoop) noexcept
+{
+    // Generación impar mientras se escribe la petición: el streamer no la lee a medias
+    generation.fetch_add(1, std::memory_order_acq_rel);
+
+    requestData.store(&data, std::memory_order_relaxed);
+    requestStart.store(firstLogicalFrame, std::memory_order_relaxed);
+    requestLoopActive.store(newLoop.active, std::memory_order_relaxed);
+    requestLoopStart.store(newLoop.start, std::memory_order_relaxed);
+    requestLoopEnd.store(newLoop.end, std::memory_order_relaxed);
+    requestLoopCrossfade.store(newLoop.crossfade, std::memory_order_relaxed);
+    readFrame.store(firstLogicalFrame, std::memory_order_relaxed);
+
+    voiceGeneration = generation.fetch_add(1, std::memory_order_release) + 1;
+    active.store(true, std::memory_order_release);
+}
+
+void VoiceStream::stop() noexcept
+{
+    active.store(false, std::memory_order_release);
+}
+
+const float* VoiceStream::getFrames(juce::int64 first, juce::int64 last) const noexcept
+{
+    jassert(last - first < guardFrames);
+
+    if (readyGeneration.load(std::memory_order_acquire) != voiceGeneration
+         || last >= writeFrame.load(std::memory_order_acquire))
+        return nullptr;
+
+    return ring + (size_t) (first % capacity) * numLanes;
+}
+
+// ============================================================================
+// SampleStreamer
+// ============================================================================
+
+SampleStreamer::SampleStreamer()
+    : juce::Thread("Sample Streamer"),
+      clean(2, maxFramesPerPass),
+      excited(2, maxFramesPerPass),
+      seamClean(2, maxFramesPerPass),
+      seamExcited(2, maxFramesPerPass)
+{
+    startThread();
+}
+
+SampleStreamer::~SampleStreamer()
+{
+    stopThread(5000);
+}
+
+void SampleStreamer::registerStream(VoiceStream& stream)
+{
+    const juce::ScopedLock sl(lifetimeLock);
+    streams.addIfNotAlreadyThere(&stream);
+}
+
+void SampleStreamer::unregisterStream(VoiceStream& stream)
+{
+    const juce::ScopedLock sl(lifetimeLock);
+    streams.removeFirstMatchingValue(&stream);
+}
+
+void SampleStreamer::setStreamedSound(int slot, bool isStreamed)
+{
+    jassert(slot >= 0 && slot < 32);
+    const auto bit = (juce::uint32) 1 << slot;
+
+    if (isStreamed)
+    {
+        streamedSlots.fetch_or(bit, std::memory_order_release);
+        notify();
+    }
+    else
+    {
+        streamedSlots.fetch_and(~bit, std::memory_order_release);
+    }
+}
+
+void SampleStreamer::run()
+{
+    while (! threadShouldExit())
+    {
+        bool didWork = false;
+        bool anyActive = false;
+
+        {
+            const juce::ScopedLock sl(lifetimeLock);
+
+            for (auto* stream : streams)
+            {
+                didWork = service(*stream) || didWork;
+                anyActive = anyActive || stream->active.load(std::memory_order_relaxed);
+            }
+        }
+
+        if (! didWork)
+        {
+            idlePasses.fetch_add(1, std::memory_order_release);
+            idleEvent.signal();
+
+            const bool mayStream = anyActive || streamedSlots.load(std::memory_order_acquire) != 0;
+            wait(mayStream ? pollIntervalMs : idleWaitMs);
+        }
+    }
+}
+
+bool SampleStreamer::waitUntilBuffered(int timeoutMs)
+{
+    // La vuelta en curso puede haber empezado antes que las notas nuevas: hace falta la siguiente.
+    // Cada vuelta se adelanta con notify() para no esperar al intervalo de sondeo
+    const auto target = idlePasses.load(std::memory_order_acquire) + 2;
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+
+    while (idlePasses.load(std::memory_order_acquire) < target)
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+
+        if (now >= deadline)
+            return false;
+
+        notify();
+        idleEvent.wait((int) (deadline - now));
+    }
+
+    return true;
+}
+
+bool SampleStreamer::service(VoiceStream& stream)
+{
+    const auto requestGeneration = stream.generation.load(std::memory_order_acquire);
+
+    if ((requestGeneration & 1) != 0)
+        return false;
+
+    if (! stream.active.load(std::memory_order_acquire))
+    {
+        // Nota terminada: se sueltan los lectores (y su copia descifrada) hasta la siguiente
+        stream.cleanReader.reset();
+        stream.excitedReader.reset();
+        return false;
+    }
+
+    if (requestGeneration != stream.servedGeneration)
+    {
+        auto* data = stream.requestData.load(std::memory_order_relaxed);
+        const auto start = stream.requestStart.load(std::memory_order_relaxed);
+
+        StreamLoop loop;
+        loop.active = stream.requestLoopActive.load(std::memory_order_relaxed);
+        loop.start = stream.requestLoopStart.load(std::memory_order_relaxed);
+        loop.end = stream.requestLoopEnd.load(std::memory_order_relaxed);
+        loop.crossfade = stream.requestLoopCrossfade.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Si la voz ha cambiado de nota mientras se leía, se atiende en la siguiente pasada.
+        // Si no, los datos siguen vivos: la voz los usaba y nadie los libera sin lifetimeLock.
+        if (stream.generation.load(std::memory_order_relaxed) != requestGeneration || data == nullptr)
+            return false;
+
+        auto readers = data->openStreamReaders();
+        stream.cleanReader = std::move(readers.first);
+        stream.excitedReader = std::move(readers.second);
+        stream.soundLength = data->getLength();
+        stream.loop = loop;
+
+        stream.writeFrame.store(start, std::memory_order_relaxed);
+        stream.servedGeneration = requestGeneration;
+        stream.readyGeneration.store(requestGeneration, std::memory_order_release);
+    }
+
+    if (stream.cleanReader == nullptr || stream.excitedReader == nullptr)
+        return false;
+
+    const auto writeFrame = stream.writeFrame.load(std::memory_order_relaxed);
+    const auto readFrame = stream.readFrame.load(std::memory_order_acquire);
+
+    // Se dejan historyFrames detrás de la lectura para los taps del interpolador.
+    // Sin loop basta con tailFrames de silencio tras el final
+    auto numFrames = (juce::int64) VoiceStream::capacity - 1 - VoiceStream::historyFrames - (writeFrame - readFrame);
+
+    if (! stream.loop.active)
+        numFrames = juce::jmin(numFrames, stream.soundLength + VoiceStream::tailFrames - writeFrame);
+
+    numFrames = juce::jmin(numFrames, (juce::int64) maxFramesPerPass);
+
+    if (numFrames <= 0)
+        return false;
+
+    produceFrames(stream, writeFrame, (int) numFrames);
+    stream.writeFrame.store(writeFrame + numFrames, std::memory_order_release);
+    return true;
+}
+
+void SampleStreamer::readSource(VoiceStream& stream, juce::int64 sourceStart, int numFrames, int destOffset,
+                                juce::AudioBuffer<float>& cleanDest, juce::AudioBuffer<float>& excitedDest)
+{
+    // Más allá del final del fichero el lector devuelve silencio
+    stream.cleanReader->read(&cleanDest, destOffset, numFrames, sourceStart, true, true);
+    stream.excitedReader->read(&excitedDest, destOffset, numFrames, sourceStart, true, true);
+}
+
+void SampleStreamer::produceFrames(VoiceStream& stream, juce::int64 firstLogicalFrame, int numFrames)
+{
+    const auto& loop = stream.loop;
+    const auto loopLength = loop.end - loop.start;
+    const auto seamStart = loop.end - loop.crossfade;
+
+    for (int produced = 0; produced < numFrames;)
+    {
+        const auto logicalFrame = firstLogicalFrame + produced;
+        const auto remaining = numFrames - produced;
+
+        // Posición lógica -> posición en el sonido: tras el primer paso se repite [start, end)
+        auto source = logicalFrame;
+
+        if (loop.active && logicalFrame >= loop.end)
+            source = loop.start + (logicalFrame - loop.end) % loopLength;
+
+        if (! loop.active || source < seamStart)
+        {
+            const auto piece = loop.active ? (int) juce::jmin((juce::int64) remaining, seamStart - source) : remaining;
+            readSource(stream, source, piece, produced, clean, excited);
+            produced += piece;
+            continue;
+        }
+
+        // Costura: se funde el final del loop con lo que precede a loopStart (potencia constante)
+        const auto piece = (int) juce::jmin((juce::int64) remaining, loop.end - source);
+        readSource(stream, source, piece, produced, clean, excited);
+        readSource(stream, source - loopLength, piece, produced, seamClean, seamExcited);
+
+        for (int i = 0; i < piece; ++i)
+        {
+            const auto fade = (float) (source + i - seamStart) / (float) loop.crossfade;
+            const float fadeOut = std::cos(fade * juce::MathConstants<float>::halfPi);
+            const float fadeIn = std::sin(fade * juce::MathConstants<float>::halfPi);
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                float* c = clean.getWritePointer(channel, produced + i);
+                float* e = excited.getWritePointer(channel, produced + i);
+                *c = *c * fadeOut + seamClean.getSample(channel, produced + i) * fadeIn;
+                *e = *e * fadeOut + seamExcited.getSample(channel, produced + i) * fadeIn;
+            }
+        }
+
+        produced += piece;
+    }
+
+    // Entrelazado al ring, que puede dar la vuelta en mitad del bloque
+    const float* cleanL = clean.getReadPointer(0);
+    const float* cleanR = clean.getReadPointer(1);
+    const float* excitedL = excited.getReadPointer(0);
+    const float* excitedR = excited.getReadPointer(1);
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        const auto slot = (int) ((firstLogicalFrame + i) % VoiceStream::capacity);
+        float* frame = stream.ring + (size_t) slot * VoiceStream::numLanes;
+        frame[0] = cleanL[i];
+        frame[1] = excitedL[i];
+        frame[2] = cleanR[i];
+        frame[3] = excitedR[i];
+
+        // Los primeros frames se repiten tras el final del ring
+        if (slot < VoiceStream::guardFrames)
+            std::copy(frame, frame + VoiceStream::numLanes, stream.ring + (size_t) (VoiceStream::capacity + slot) * VoiceStream::numLanes);
+    }
+}
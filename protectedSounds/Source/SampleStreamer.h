@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    SampleStreamer.h
+    Created: 17 Oct 2026 8:20:13pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class DualLayerSampleData;
+
+// Loop fijado al empezar una nota en streaming, en frames del sonido
+struct StreamLoop
+{
+    bool active = false;
+    juce::int64 start = 0;
+    juce::int64 end = 0;
+    juce::int64 crossfade = 0;
+};
+
+// Ring buffer de una voz para sonidos que no caben en memoria. El hilo de audio lo lee y
+// el SampleStreamer lo rellena con frames entrelazados [cleanL, excitedL, cleanR, excitedR]
+// en orden lógico de reproducción: los saltos y la costura del loop ya vienen resueltos.
+class VoiceStream
+{
+public:
+    static constexpr int capacity = 16384; // frames
+    static constexpr int numLanes = 4;
+
+    // Márgenes para el interpolador de la voz: frames que se conservan detrás de la posición de
+    // lectura, silencio tras el final del sonido y copia de los primeros frames del ring tras su
+    // final, para que los taps de una posición siempre sean contiguos aunque el ring dé la vuelta
+    static constexpr int historyFrames = 8;
+    static constexpr int tailFrames = 8;
+    static constexpr int guardFrames = 16;
+
+    VoiceStream();
+
+    // Hilo de audio: pide frames a partir de firstLogicalFrame
+    void start(const DualLayerSampleData& data, juce::int64 firstLogicalFrame, const StreamLoop& loop) noexcept;
+    void stop() noexcept;
+
+    // Hilo de audio: nullptr si el frame aún no ha llegado
+    const float* getFrame(juce::int64 logicalFrame) const noexcept { return getFrames(logicalFrame, logicalFrame); }
+
+    // Hilo de audio: puntero al primer frame de [first, last], contiguos; nullptr si falta alguno.
+    // El rango no puede ser más largo que guardFrames ni empezar antes del frame pedido en start()
+    const float* getFrames(juce::int64 first, juce::int64 last) const noexcept;
+
+    // Hilo de audio: los frames anteriores ya no hacen falta y se pueden sobrescribir
+    void setReadPosition(juce::int64 logicalFrame) noexcept { readFrame.store(logicalFrame, std::memory_order_release); }
+
+    bool isLooping() const noexcept { return requestLoopActive.load(std::memory_order_relaxed); }
+
+    // Hilo de audio: true si ya han llegado todos los frames hasta lastFrame. Lo que no cabe
+    // en el ring detrás de la última posición de lectura no se puede pedir todavía y no cuenta
+    bool hasFramesUpTo(juce::int64 lastFrame) const noexcept
+    {
+        lastFrame = juce::jmin(lastFrame, readFrame.load(std::memory_order_relaxed) + capacity - 2 - historyFrames);
+
+        return readyGeneration.load(std::memory_order_acquire) == voiceGeneration
+                && lastFrame < writeFrame.load(std::memory_order_acquire);
+    }
+
+private:
+    friend class SampleStreamer;
+
+    // Petición: la escribe la voz entre dos incrementos de generation (impar = escribiendo)
+    std::atomic<juce::uint32> generation { 0 };
+    std::atomic<bool> active { false };
+    std::atomic<const DualLayerSampleData*> requestData { nullptr };
+    std::atomic<juce::int64> requestStart { 0 };
+    std::atomic<bool> requestLoopActive { false };
+    std::atomic<juce::int64> requestLoopStart { 0 }, requestLoopEnd { 0 }, requestLoopCrossfade { 0 };
+    juce::uint32 voiceGeneration { 0 }; // sólo hilo de audio
+
+    // Estado del ring
+    std::atomic<juce::uint32> readyGeneration { 0 };
+    std::atomic<juce::int64> writeFrame { 0 };
+    std::atomic<juce::int64> readFrame { 0 };
+    juce::HeapBlock<float> storage;
+    float* ring { nullptr };
+
+    // Estado del streamer
+    juce::uint32 servedGeneration { 0 };
+    std::unique_ptr<juce::AudioFormatReader> cleanReader, excitedReader;
+    juce::int64 soundLength { 0 };
+    StreamLoop loop;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceStream)
+};
+
+// Hilo que precarga, descifra y decodifica el audio de las voces en streaming.
+// No se le avisa desde el hilo de audio (eso bloquearía): revisa las voces cada pocos ms, pero
+// sólo mientras alguna voz está en streaming o hay algún sonido en streaming publicado. Si no,
+// duerme hasta que el cargador publique uno (setStreamedSound).
+class SampleStreamer : private juce::Thread
+{
+public:
+    SampleStreamer();
+    ~SampleStreamer() override;
+
+    void registerStream(VoiceStream& stream);
+    void unregisterStream(VoiceStream& stream);
+
+    // Cargador: si el sonido publicado en un slot (0-31) va en streaming. Hay que llamarlo antes
+    // de publicarlo, para que el hilo ya esté despierto cuando empiece la primera nota
+    void setStreamedSound(int slot, bool isStreamed);
+
+    // Quien libere DualLayerSampleData tiene que tener este lock: así el streamer nunca
+    // lee unos datos mientras se destruyen
+    juce::CriticalSection& getLifetimeLock() noexcept { return lifetimeLock; }
+
+    // Sólo para render offline (el hilo de audio puede bloquearse): espera a una vuelta completa
+    // sin trabajo, con todos los rings llenos o hasta el final de su sonido. Devuelve false si
+    // se agota el tiempo. Son dos vueltas del streamer: sólo hay que llamarlo si a alguna voz le
+    // faltan frames (DualLayerSynthesiser::isStreamBuffered)
+    bool waitUntilBuffered(int timeoutMs);
+
+private:
+    static constexpr int maxFramesPerPass = 4096;
+    static constexpr int pollIntervalMs = 2;
+
+    // Sin nada en streaming el hilo se despierta igualmente cada idleWaitMs: una nota puede haber
+    // empezado con los datos anteriores justo antes de que el audio adopte los nuevos. Es menos
+    // que la cabeza que suena desde memoria (DualLayerSampleData::streamHeadSeconds)
+    static constexpr int idleWaitMs = 250;
+
+    void run() override;
+    bool service(VoiceStream& stream);
+    void produceFrames(VoiceStream& stream, juce::int64 firstLogicalFrame, int numFrames);
+    void readSource(VoiceStream& stream, juce::int64 sourceStart, int numFrames, int destOffset,
+                    juce::AudioBuffer<float>& cleanDest, juce::AudioBuffer<float>& excitedDest);
+
+    juce::CriticalSection lifetimeLock;
+    juce::Array<VoiceStream*> streams;
+
+    // Un bit por slot con un sonido en streaming publicado
+    std::atomic<juce::uint32> streamedSlots { 0 };
+
+    // Vueltas completas sin trabajo pendiente (ver waitUntilBuffered)
+    std::atomic<juce::uint32> idlePasses { 0 };
+    juce::WaitableEvent idleEvent;
+
+    juce::AudioBuffer<float> clean, excited, seamClean, seamExcited;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleStreamer)
+};
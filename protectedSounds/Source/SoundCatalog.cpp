@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    SoundCatalog.cpp
+    Created: 17 Oct 2026 10:31:09pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "SoundCatalog.h"
+
+bool SoundCatalog::loadFromJSON(const juce::String& json, juce::String& error)
+{
+    juce::var root;
+    const auto result = juce::JSON::parse(json, root);
+
+    if (result.failed())
+    {
+        error = result.getErrorMessage();
+        return false;
+    }
+
+    if ((int) root["version"] != currentVersion)
+    {
+        error = "Unsupported catalog version";
+        return false;
+    }
+
+    const auto* list = root["sounds"].getArray();
+
+    if (list == nullptr)
+    {
+        error = "Catalog has no sound list";
+        return false;
+    }
+
+    sounds.clear();
+    indexByName.clear();
+
+    for (const auto& entry : *list)
+    {
+        SoundInfo info;
+        info.name = entry["name"].toString();
+        info.cleanResource = entry["clean"].toString();
+        info.excitedResource = entry.hasProperty("excited") ? entry["excited"].toString() : info.cleanResource;
+        info.lengthInSamples = (juce::int64) entry["lengthInSamples"];
+        info.sampleRate = (double) entry["sampleRate"];
+        info.numChannels = (int) entry["numChannels"];
+        info.peak = (float) (double) entry["peak"];
+        info.loopStart = (juce::int64) entry["loopStart"];
+        info.loopEnd = (juce::int64) entry["loopEnd"];
+
+        if (info.cleanResource.isEmpty())
+            info.cleanResource = info.name;
+
+        if (info.name.isEmpty() || indexByName.contains(info.name))
+        {
+            error = "Missing or duplicate sound name: " + info.name;
+            return false;
+        }
+
+        add(info);
+    }
+
+    return true;
+}
+
+juce::String SoundCatalog::toJSON() const
+{
+    juce::Array<juce::var> list;
+
+    for (const auto& info : sounds)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("name", info.name);
+        entry->setProperty("clean", info.cleanResource);
+        entry->setProperty("excited", info.excitedResource);
+        entry->setProperty("lengthInSamples", info.lengthInSamples);
+        entry->setProperty("sampleRate", info.sampleRate);
+        entry->setProperty("numChannels", info.numChannels);
+        entry->setProperty("peak", info.peak);
+        entry->setProperty("loopStart", info.loopStart);
+        entry->setProperty("loopEnd", info.loopEnd);
+        list.add(juce::var(entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("version", currentVersion);
+    root->setProperty("sounds", list);
+
+    return juce::JSON::toString(juce::var(root));
+}
+
+void SoundCatalog::add(const SoundInfo& info)
+{
+    indexByName.set(info.name, (int) sounds.size());
+    sounds.push_back(info);
+}
+
+const SoundInfo* SoundCatalog::find(const juce::String& name) const
+{
+    if (! indexByName.contains(name))
+        return nullptr;
+
+    return &sounds[(size_t) indexByName[name]];
+}
+
+juce::StringArray SoundCatalog::getNames() const
+{
+    juce::StringArray names;
+
+    for (const auto& info : sounds)
+        names.add(info.name);
+
+    return names;
+}
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    SoundCatalog.h
+    Created: 17 Oct 2026 10:31:09pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Datos de un sonido del catálogo. Los metadatos se calculan al generar el catálogo
+// (encrypt_audio --catalog), así que se conocen sin decodificar nada.
+struct SoundInfo
+{
+    juce::String name;            // nombre que ve el usuario y clave de búsqueda
+    juce::String cleanResource;   // recurso sin sufijo ("_wav", "_psc", ...)
+    juce::String excitedResource;
+
+    juce::int64 lengthInSamples = 0;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    float peak = 0.0f;
+
+    // Loop por defecto en samples del sonido
+    juce::int64 loopStart = 0;
+    juce::int64 loopEnd = 0;
+
+    bool hasMetadata() const noexcept { return lengthInSamples > 0 && sampleRate > 0.0; }
+    double getLengthInSeconds() const noexcept { return hasMetadata() ? (double) lengthInSamples / sampleRate : 0.0; }
+};
+
+// Catálogo de sonidos leído de un manifest JSON:
+//
+//   { "version": 1,
+//     "sounds": [ { "name": "...", "clean": "...", "excited": "...",
+//                   "lengthInSamples": 0, "sampleRate": 0, "numChannels": 0, "peak": 0,
+//                   "loopStart": 0, "loopEnd": 0 }, ... ] }
+//
+// Las búsquedas por nombre son O(1) con una tabla hash. Inmutable una vez cargado.
+class SoundCatalog
+{
+public:
+    static constexpr int currentVersion = 1;
+
+    // Nombre del recurso del manifest dentro del paquete ("catalog.json")
+    static constexpr const char* resourceName = "catalog_json";
+
+    SoundCatalog() = default;
+
+    bool loadFromJSON(const juce::String& json, juce::String& error);
+    juce::String toJSON() const;
+
+    void add(const SoundInfo& info);
+
+    const SoundInfo* find(const juce::String& name) const;
+    const std::vector<SoundInfo>& getSounds() const noexcept { return sounds; }
+    juce::StringArray getNames() const;
+
+private:
+    std::vector<SoundInfo> sounds;
+    juce::HashMap<juce::String, int> indexByName;
+
+    JUCE_LEAK_DETECTOR(SoundCatalog)
+};
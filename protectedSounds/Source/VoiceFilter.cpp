@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    VoiceFilter.cpp
+    Created: 18 Oct 2026 2:05:12am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "VoiceFilter.h"
+
+void VoiceFilter::computeCoefficients(const float* cutoffsHz, float resonance, double sampleRate,
+                                      Coefficients* dest, int numVoices) noexcept
+{
+    // Por debajo de Nyquist con margen: tan() se dispara cerca de pi/2
+    const auto maxCutoff = (float) (sampleRate * 0.45);
+    const auto piOverRate = juce::MathConstants<float>::pi / (float) sampleRate;
+    const auto r2 = 1.0f / juce::jmax(0.01f, resonance);
+
+    // Aproximación de Padé de tan(): sin ramas ni llamadas, el compilador vectoriza el bucle
+    // entre voces. Con el corte limitado a 0.45 fs el argumento no pasa de 0.45 pi.
+    for (int i = 0; i < numVoices; ++i)
+    {
+        const auto g = juce::dsp::FastMathApproximations::tan(juce::jlimit(20.0f, maxCutoff, cutoffsHz[i]) * piOverRate);
+        dest[i] = { g, 1.0f / (1.0f + r2 * g + g * g), r2 };
+    }
+}
+
+void VoiceFilter::reset() noexcept
+{
+    state = {};
+    delta = { 0.0f, 0.0f, 0.0f };
+    primed = false;
+}
+
+void VoiceFilter::setTarget(const Coefficients& target, int numSamples) noexcept
+{
+    if (! primed || numSamples <= 0)
+    {
+        current = target;
+        delta = { 0.0f, 0.0f, 0.0f };
+        primed = true;
+        return;
+    }
+
+    const auto scale = 1.0f / (float) numSamples;
+    delta = { (target.g - current.g) * scale, (target.h - current.h) * scale, (target.r2 - current.r2) * scale };
+}
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    VoiceFilter.h
+    Created: 18 Oct 2026 2:05:12am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Filtro de estado variable TPT estéreo para una voz; mismo diseño que
+// juce::dsp::StateVariableTPTFilter pero con los coeficientes interpolados por sample entre
+// actualizaciones de control, para poder modular el corte sin escalones.
+class VoiceFilter
+{
+public:
+    enum class Type { lowpass, bandpass, highpass };
+
+    // Coeficientes de un corte: g = tan(pi * fc / fs), R2 = 1 / resonancia, h = 1 / (1 + R2 g + g²)
+    struct Coefficients
+    {
+        float g = 0.0f;
+        float h = 1.0f;
+        float r2 = 1.0f;
+    };
+
+    // Calcula los coeficientes de varias voces de una pasada (bucle sin dependencias entre voces)
+    static void computeCoefficients(const float* cutoffsHz, float resonance, double sampleRate,
+                                    Coefficients* dest, int numVoices) noexcept;
+
+    void reset() noexcept;
+
+    // Llega a target en numSamples; la primera vez tras reset() salta directamente
+    void setTarget(const Coefficients& target, int numSamples) noexcept;
+
+    void process(Type type, float& left, float& right) noexcept
+    {
+        const auto g = current.g;
+        const auto h = current.h;
+        const auto gr = g + current.r2;
+
+        left = processSample(type, left, g, h, gr, state[0]);
+        right = processSample(type, right, g, h, gr, state[1]);
+
+        current.g += delta.g;
+        current.h += delta.h;
+        current.r2 += delta.r2;
+    }
+
+private:
+    struct ChannelState
+    {
+        float s1 = 0.0f;
+        float s2 = 0.0f;
+    };
+
+    static float processSample(Type type, float x, float g, float h, float gr, ChannelState& s) noexcept
+    {
+        const auto highpass = h * (x - s.s1 * gr - s.s2);
+        const auto bandpass = highpass * g + s.s1;
+        s.s1 = highpass * g + bandpass;
+
+        const auto lowpass = bandpass * g + s.s2;
+        s.s2 = bandpass * g + lowpass;
+
+        return type == Type::lowpass ? lowpass : (type == Type::bandpass ? bandpass : highpass);
+    }
+
+    Coefficients current, delta { 0.0f, 0.0f, 0.0f };
+    std::array<ChannelState, 2> state {};
+    bool primed { false };
+
+    JUCE_LEAK_DETECTOR(VoiceFilter)
+};
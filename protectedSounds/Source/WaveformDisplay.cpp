@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+    WaveformDisplay.cpp
+    Created: 18 Oct 2026 12:02:40am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "WaveformDisplay.h"
+
+WaveformDisplay::WaveformDisplay()
+{
+    setOpaque(false);
+}
+
+void WaveformDisplay::setPeaks(std::shared_ptr<const WaveformPeaks> newPeaks)
+{
+    if (newPeaks == peaks)
+        return;
+
+    peaks = std::move(newPeaks);
+    waveformImage = {};
+    repaint();
+}
+
+void WaveformDisplay::resized()
+{
+    waveformImage = {};
+}
+
+// ============================================================================
+// CAPAS
+// ============================================================================
+
+float WaveformDisplay::fractionToX(double fraction) const noexcept
+{
+    return (float) (juce::jlimit(0.0, 1.0, fraction) * getWidth());
+}
+
+double WaveformDisplay::xToFraction(float x) const noexcept
+{
+    return getWidth() > 0 ? juce::jlimit(0.0, 1.0, (double) x / getWidth()) : 0.0;
+}
+
+juce::Rectangle<int> WaveformDisplay::getMarkerArea(float x) const noexcept
+{
+    // Línea de 2 px más el área de agarre
+    const auto halfWidth = (int) std::ceil(markerDragTolerance) + 2;
+    return { (int) x - halfWidth, 0, halfWidth * 2 + 1, getHeight() };
+}
+
+void WaveformDisplay::repaintBetween(float oldX, float newX)
+{
+    // La selección cambia entre la posición vieja y la nueva; los marcadores en los dos extremos
+    repaint(getMarkerArea(oldX).getUnion(getMarkerArea(newX)));
+}
+
+void WaveformDisplay::setLoopRegion(bool enabled, double startFraction, double endFraction)
+{
+    if (enabled != loopEnabled)
+    {
+        loopEnabled = enabled;
+        loopStart = startFraction;
+        loopEnd = endFraction;
+        repaintBetween(fractionToX(loopStart), fractionToX(loopEnd));
+        return;
+    }
+
+    if (startFraction != loopStart)
+    {
+        const auto oldX = fractionToX(loopStart);
+        loopStart = startFraction;
+
+        if (loopEnabled)
+            repaintBetween(oldX, fractionToX(loopStart));
+    }
+
+    if (endFraction != loopEnd)
+    {
+        const auto oldX = fractionToX(loopEnd);
+        loopEnd = endFraction;
+
+        if (loopEnabled)
+            repaintBetween(oldX, fractionToX(loopEnd));
+    }
+}
+
+void WaveformDisplay::setPlayheads(const Playhead* newPlayheads, int numNewPlayheads)
+{
+    numNewPlayheads = juce::jmin(numNewPlayheads, maxPlayheads);
+
+    if (numNewPlayheads == numPlayheads && std::equal(newPlayheads, newPlayheads + numNewPlayheads, playheads.begin()))
+        return;
+
+    // Se repinta la posición vieja y la nueva de cada cursor, no toda la forma de onda
+    for (int i = 0; i < numPlayheads; ++i)
+        repaint(getMarkerArea(fractionToX(playheads[(size_t) i].position)));
+
+    std::copy(newPlayheads, newPlayheads + numNewPlayheads, playheads.begin());
+    numPlayheads = numNewPlayheads;
+
+    for (int i = 0; i < numPlayheads; ++i)
+        repaint(getMarkerArea(fractionToX(playheads[(size_t) i].position)));
+}
+
+// ============================================================================
+// PINTADO
+// ============================================================================
+
+void WaveformDisplay::renderWaveformImage(float scale)
+{
+    const auto width = juce::roundToInt((float) getWidth() * scale);
+    const auto height = juce::roundToInt((float) getHeight() * scale);
+
+    waveformImage = juce::Image(juce::Image::ARGB, juce::jmax(1, width), juce::jmax(1, height), true);
+    waveformImageScale = scale;
+
+    if (peaks == nullptr || peaks->getNumSamples() == 0)
+        return;
+
+    // Una columna min/max por píxel físico sacada de la pirámide de picos: no se toca el audio
+    juce::Graphics g(waveformImage);
+    g.setColour(juce::Colours::yellow);
+
+    const auto numSamples = peaks->getNumSamples();
+
+    for (int x = 0; x < width; ++x)
+    {
+        const auto peak = peaks->getPeak(numSamples * x / width, numSamples * (x + 1) / width);
+
+        // Escalar en el eje Y
+        const auto top = juce::jmap<float>(peak.getEnd(), -1.0f, 1.0f, (float) height, 0.0f);
+        const auto bottom = juce::jmap<float>(peak.getStart(), -1.0f, 1.0f, (float) height, 0.0f);
+
+        g.fillRect(juce::Rectangle<float>((float) x, top, 1.0f, juce::jmax(scale, bottom - top)));
+    }
+}
+
+void WaveformDisplay::paint(juce::Graphics& g)
+{
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (! waveformImage.isValid() || scale != waveformImageScale)
+        renderWaveformImage(scale);
+
+    // Sólo se compone la parte que cae dentro del área a repintar
+    g.drawImage(waveformImage, getLocalBounds().toFloat());
+
+    const auto height = (float) getHeight();
+
+    if (loopEnabled)
+    {
+        const auto startX = fractionToX(loopStart);
+        const auto endX = fractionToX(loopEnd);
+
+        g.setColour(juce::Colours::red.withAlpha(0.1f));
+        g.fillRect(juce::Rectangle<float>::leftTopRightBottom(juce::jmin(startX, endX), 0.0f, juce::jmax(startX, endX), height));
+
+        g.setColour(juce::Colours::red);
+        g.drawLine(startX, 0.0f, startX, height, 2.0f);
+        g.drawLine(endX, 0.0f, endX, height, 2.0f);
+
+        // Áreas de agarre
+        g.setColour(juce::Colours::red.withAlpha(0.3f));
+        g.fillRect(juce::Rectangle<float>(startX - markerDragTolerance, 0.0f, markerDragTolerance * 2, height));
+        g.fillRect(juce::Rectangle<float>(endX - markerDragTolerance, 0.0f, markerDragTolerance * 2, height));
+    }
+
+    for (int i = 0; i < numPlayheads; ++i)
+    {
+        const auto& playhead = playheads[(size_t) i];
+        const auto x = fractionToX(playhead.position);
+        const auto alpha = 0.3f + 0.7f * juce::jlimit(0.0f, 1.0f, playhead.level);
+
+        g.setColour((playhead.releasing ? juce::Colours::grey : juce::Colours::white).withAlpha(alpha));
+        g.drawLine(x, 0.0f, x, height, 1.0f);
+    }
+}
+
+// ============================================================================
+// RATÓN
+// ============================================================================
+
+void WaveformDisplay::mouseDown(const juce::MouseEvent& e)
+{
+    if (! loopEnabled)
+        return;
+
+    if (std::abs((float) e.x - fractionToX(loopStart)) < markerDragTolerance)
+        isDraggingStartMarker = true;
+    else if (std::abs((float) e.x - fractionToX(loopEnd)) < markerDragTolerance)
+        isDraggingEndMarker = true;
+}
+
+void WaveformDisplay::mouseDrag(const juce::MouseEvent& e)
+{
+    // Quien escucha actualiza la región con setLoopRegion, que repinta sólo lo que cambia
+    const auto fraction = xToFraction((float) e.x);
+
+    if (isDraggingStartMarker && onLoopStartDragged != nullptr)
+        onLoopStartDragged(fraction);
+    else if (isDraggingEndMarker && onLoopEndDragged != nullptr)
+        onLoopEndDragged(fraction);
+}
+
+void WaveformDisplay::mouseUp(const juce::MouseEvent&)
+{
+    isDraggingStartMarker = false;
+    isDraggingEndMarker = false;
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    WaveformDisplay.h
+    Created: 18 Oct 2026 12:02:40am
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "WaveformPeaks.h"
+
+// Forma de onda con los marcadores de loop, la región seleccionada y un cursor por voz.
+// La forma de onda se dibuja una sola vez en una imagen (a la resolución física de la pantalla)
+// que sólo se rehace si cambian el sonido o el tamaño. Marcadores, selección y cursor son capas
+// que se pintan encima y al moverse sólo repintan el rectángulo que cambia.
+class WaveformDisplay : public juce::Component
+{
+public:
+    // Cursor de una voz; la opacidad sigue a la envolvente y en release se pinta atenuado
+    struct Playhead
+    {
+        double position = 0.0;
+        float level = 1.0f;
+        bool releasing = false;
+
+        bool operator==(const Playhead& other) const noexcept
+        {
+            return position == other.position && level == other.level && releasing == other.releasing;
+        }
+    };
+
+    static constexpr int maxPlayheads = 32;
+
+    WaveformDisplay();
+
+    void setPeaks(std::shared_ptr<const WaveformPeaks> newPeaks);
+
+    // Posiciones como fracción de la duración del sonido (0..1)
+    void setLoopRegion(bool enabled, double startFraction, double endFraction);
+    void setPlayheads(const Playhead* newPlayheads, int numNewPlayheads);
+
+    // Arrastre de los marcadores; reciben la nueva posición como fracción
+    std::function<void(double)> onLoopStartDragged;
+    std::function<void(double)> onLoopEndDragged;
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+    void mouseUp(const juce::MouseEvent& e) override;
+
+private:
+    void renderWaveformImage(float scale);
+    float fractionToX(double fraction) const noexcept;
+    double xToFraction(float x) const noexcept;
+    juce::Rectangle<int> getMarkerArea(float x) const noexcept;
+    void repaintBetween(float oldX, float newX);
+
+    std::shared_ptr<const WaveformPeaks> peaks;
+    juce::Image waveformImage;
+    float waveformImageScale { 0.0f };
+
+    bool loopEnabled { false };
+    double loopStart { 0.0 };
+    double loopEnd { 1.0 };
+    std::array<Playhead, maxPlayheads> playheads {};
+    int numPlayheads { 0 };
+
+    bool isDraggingStartMarker = false;
+    bool isDraggingEndMarker = false;
+    float markerDragTolerance = 5.0f; // pixels
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformDisplay)
+};
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    WaveformPeaks.cpp
+    Created: 17 Oct 2026 11:14:52pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#include "WaveformPeaks.h"
+
+WaveformPeaks::WaveformPeaks(juce::int64 totalNumSamples)
+    : numSamples(juce::jmax((juce::int64) 0, totalNumSamples))
+{
+    while (numSamples / baseBinSize > maxBaseBins)
+        baseBinSize *= 2;
+
+    levels.emplace_back();
+    levels[0].reserve((size_t) (numSamples / baseBinSize + 1));
+}
+
+void WaveformPeaks::addFrames(const float* left, const float* right, int numFrames, int stride)
+{
+    auto& base = levels[0];
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        auto low = left[(size_t) i * (size_t) stride];
+        auto high = low;
+
+        if (right != nullptr)
+        {
+            const auto value = right[(size_t) i * (size_t) stride];
+            low = juce::jmin(low, value);
+            high = juce::jmax(high, value);
+        }
+
+        currentBin = samplesInBin == 0 ? juce::Range<float>(low, high)
+                                       : juce::Range<float>(juce::jmin(currentBin.getStart(), low),
+                                                            juce::jmax(currentBin.getEnd(), high));
+
+        if (++samplesInBin == baseBinSize)
+        {
+            base.push_back(currentBin);
+            samplesInBin = 0;
+        }
+    }
+}
+
+void WaveformPeaks::finish()
+{
+    if (samplesInBin > 0)
+    {
+        levels[0].push_back(currentBin);
+        samplesInBin = 0;
+    }
+
+    // Cada nivel junta parejas del anterior hasta que queda un solo bloque
+    while (levels.back().size() > 1)
+    {
+        const auto& previous = levels.back();
+        std::vector<juce::Range<float>> level;
+        level.reserve((previous.size() + 1) / 2);
+
+        for (size_t i = 0; i < previous.size(); i += 2)
+            level.push_back(i + 1 < previous.size() ? previous[i].getUnionWith(previous[i + 1]) : previous[i]);
+
+        levels.push_back(std::move(level));
+    }
+}
+
+juce::Range<float> WaveformPeaks::getPeak(juce::int64 startSample, juce::int64 endSample) const
+{
+    startSample = juce::jlimit((juce::int64) 0, numSamples, startSample);
+    endSample = juce::jlimit(startSample, numSamples, endSample);
+
+    if (endSample <= startSample || levels[0].empty())
+        return {};
+
+    // El nivel más grueso cuyo bloque no es mayor que el intervalo: como mucho se miran unos pocos bloques
+    const auto span = endSample - startSample;
+    int level = 0;
+
+    while (level + 1 < (int) levels.size() && getBinSize(level + 1) <= span)
+        ++level;
+
+    const auto& bins = levels[(size_t) level];
+    const auto binSize = getBinSize(level);
+    const auto first = (size_t) (startSample / binSize);
+    const auto last = juce::jmin((size_t) ((endSample - 1) / binSize), bins.size() - 1);
+
+    auto peak = bins[first];
+
+    for (auto i = first + 1; i <= last; ++i)
+        peak = peak.getUnionWith(bins[i]);
+
+    return peak;
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    WaveformPeaks.h
+    Created: 17 Oct 2026 11:14:52pm
+    Author:  Carlos Garin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Pirámide de picos min/max de un sonido para dibujar su forma de onda. El nivel 0 guarda el
+// mínimo y el máximo de cada bloque de baseBinSize samples y cada nivel siguiente junta dos
+// bloques del anterior. Para cualquier zoom se elige el nivel cuyo bloque cabe en un píxel,
+// así que dibujar cuesta O(píxeles) y no depende de la duración del sonido.
+// Se construye en segundo plano (hilo del cargador) y después es inmutable.
+class WaveformPeaks
+{
+public:
+    // Se añaden todos los samples en orden con addFrames y se termina con finish()
+    explicit WaveformPeaks(juce::int64 totalNumSamples);
+
+    // right puede ser nullptr (mono); stride es la distancia entre samples consecutivos
+    void addFrames(const float* left, const float* right, int numFrames, int stride = 1);
+    void finish();
+
+    juce::int64 getNumSamples() const noexcept { return numSamples; }
+
+    // Mínimo y máximo (start/end del Range) de los samples [startSample, endSample)
+    juce::Range<float> getPeak(juce::int64 startSample, juce::int64 endSample) const;
+
+private:
+    // El nivel 0 se limita a unos maxBaseBins bloques para acotar la memoria con sonidos largos
+    static constexpr int minBaseBinSize = 16;
+    static constexpr juce::int64 maxBaseBins = 1 << 20;
+
+    juce::int64 getBinSize(int level) const noexcept { return baseBinSize << level; }
+
+    juce::int64 numSamples { 0 };
+    juce::int64 baseBinSize { minBaseBinSize };
+    std::vector<std::vector<juce::Range<float>>> levels;
+
+    // Estado de la construcción
+    juce::Range<float> currentBin;
+    juce::int64 samplesInBin { 0 };
+
+    JUCE_LEAK_DETECTOR(WaveformPeaks)
+};